@@ -27,15 +27,31 @@
 #include <string.h>
 #include <stddef.h>
 #include <errno.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#if defined(__GLIBC__)
+#include <malloc.h>             // mallinfo2()
+#endif
 
 // Scallop
 #include "scallop.h"
 #include "command.h"
 #include "routine.h"
+#include "memo.h"
+#include "lines.h"
+#include "list.h"
+#include "map.h"
 #include "whilex.h"
+#include "forx.h"
+#include "foreachx.h"
 #include "ifelse.h"
+#include "switchx.h"
 #include "parser.h"
 #include "builtin.h"
+#include "clock.h"
+#include "logring.h"
+#include "script.h"
+#include "snapshot.h"
 
 // RayCO
 #include "console.h"
@@ -308,6 +324,66 @@ static int builtin_handler_log_file(void * scmd,
     return 0;
 }
 
+//------------------------------------------------------------------------|
+static int builtin_handler_log_ring(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a file path/name");
+        return ERROR_MARKER_DEC;
+    }
+
+#ifndef SCALLOP_LOG_RING
+    console->error(console, "not built with the ring-buffer log (LOG_RING=1)");
+    return ERROR_MARKER_DEC;
+#endif
+
+    if (!scallop_logring_dump(args[1]))
+    {
+        console->error(console, "could not write %s", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    scallop_logring_clear();
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_log_stream(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+#ifndef SCALLOP_LOG_RING
+    console->error(console, "not built with the ring-buffer log (LOG_RING=1)");
+    return ERROR_MARKER_DEC;
+#endif
+
+    if (!scallop_logring_stream(argc < 2 ? NULL : args[1]))
+    {
+        console->error(console, "could not open %s for writing", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (argc < 2 && scallop_logring_dropped() > 0)
+    {
+        console->print(console,
+                       "%zu log entries dropped",
+                       scallop_logring_dropped());
+    }
+
+    return 0;
+}
+
 //------------------------------------------------------------------------|
 static int builtin_handler_plugin(void * scmd,
                                   void * context,
@@ -398,9 +474,22 @@ static int builtin_handler_print(void * scmd,
 {
     scallop_t * scallop = (scallop_t *) context;
     console_t * console = scallop->console(scallop);
+    scallop_stream_t * input = scallop->input(scallop);
+    const char * line = NULL;
     long result = 0;
     int argnum = 1;
 
+    // Print lines piped in, as they are
+    if (argc < 2 && input)
+    {
+        while ((line = input->read_line(input)) != NULL)
+        {
+            console->print(console, "%s", line);
+        }
+
+        return 0;
+    }
+
     // Need something to print!
     if (argc < 2)
     {
@@ -446,6 +535,34 @@ static int builtin_handler_print(void * scmd,
     return (int) result;
 }
 
+//------------------------------------------------------------------------|
+// Assign all the lines of piped input to a variable, one per line
+static int builtin_assign_input(scallop_t * scallop,
+                                const char * varname,
+                                scallop_stream_t * input)
+{
+    bytes_t * value = bytes_pub.create(NULL, 0);
+    const char * line = NULL;
+    bool first = true;
+
+    while ((line = input->read_line(input)) != NULL)
+    {
+        if (!first)
+        {
+            value->append(value, "\n", 1);
+        }
+
+        value->append(value, line, strlen(line));
+        first = false;
+    }
+
+    bool assigned = scallop->assign_variable(scallop,
+                                             varname,
+                                             value->cstr(value));
+    value->destroy(value);
+    return assigned ? 0 : ERROR_MARKER_DEC;
+}
+
 //------------------------------------------------------------------------|
 static int builtin_handler_assign(void * scmd,
                                   void * context,
@@ -454,6 +571,7 @@ static int builtin_handler_assign(void * scmd,
 {
     scallop_t * scallop = (scallop_t *) context;
     console_t * console = scallop->console(scallop);
+    scallop_stream_t * input = scallop->input(scallop);
     long result = 0;
 
     if (argc < 2)
@@ -461,6 +579,11 @@ static int builtin_handler_assign(void * scmd,
         console->error(console, "expected a variable name");
         return ERROR_MARKER_DEC;
     }
+    else if (argc < 3 && input)
+    {
+        // Assign everything piped in, as it is
+        return builtin_assign_input(scallop, args[1], input);
+    }
     else if (argc < 3)
     {
         console->error(console, "expected a variable value");
@@ -483,13 +606,19 @@ static int builtin_handler_assign(void * scmd,
 
         // Numeric assignment
         bytes_t * value = bytes_pub.print_create("%ld", result);
-        scallop->assign_variable(scallop, args[1], value->cstr(value));
+        bool assigned = scallop->assign_variable(scallop,
+                                                 args[1],
+                                                 value->cstr(value));
         value->destroy(value);
+        if (!assigned)
+        {
+            return ERROR_MARKER_DEC;
+        }
     }
-    else
+    else if (!scallop->assign_variable(scallop, args[1], args[2]))
     {
-        // Direct string assignment
-        scallop->assign_variable(scallop, args[1], args[2]);
+        // Direct string assignment, refused by a bound loop variable
+        return ERROR_MARKER_DEC;
     }
 
     return result;
@@ -510,228 +639,1451 @@ static int builtin_handler_source(void * scmd,
         return ERROR_MARKER_DEC;
     }
 
-    FILE * source = fopen(args[1], "r");
-    if (!source)
-    {
-        console->error(console, "could not open %s for reading", args[1]);
-        return ERROR_MARKER_DEC;
-    }
-
     // Store script arguments in scallop's variable
     // collection so dispatch can perform substitution.
     scallop->store_args(scallop, argc, args);
 
-    // Stash the current console input source & swap to source file
-    FILE * input = console->get_inputf(console);
-    console->set_inputf(console, source);
+    // Without a cache, or a script object to keep, dispatch commands
+    // from the script until EOF.  run_file() reports why it failed.
+    const char * cache = scallop->cache_dir(scallop);
+    scallop_script_t * script = NULL;
+    if (cache)
+    {
+        script = scallop_script_pub.create(scallop, args[1]);
+    }
 
-    // Now get an dispatch commands from the script until EOF
-    int result = scallop->run_console(scallop, false);
+    if (!script)
+    {
+        int result = scallop->run_file(scallop, args[1]);
+        return (result < 0) ? ERROR_MARKER_DEC : result;
+    }
 
-    // Put console back to original state
-    console->set_inputf(console, input);
+    // Use the compiled script if fresh, otherwise compile and keep it.
+    // Failing to compile or save only loses the speedup.
+    if (!script->load(script, cache) && script->compile(script))
+    {
+        script->save(script, cache);
+    }
 
-    // Done with script file
-    fclose(source);
+    int result = script->run(script);
+    script->destroy(script);
     return result;
 }
 
 //------------------------------------------------------------------------|
-static int builtin_linefunc_routine(void * context,
-                                    void * object,
-                                    const char * line)
+// Bytes of heap in use, where the C library can say, otherwise zero
+static long builtin_heap_in_use()
 {
-    scallop_t * scallop = (scallop_t *) context;
-    scallop_rtn_t * routine = (scallop_rtn_t *) object;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return (long) mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
 
-    if (!routine)
+//------------------------------------------------------------------------|
+// CPU time used by the whole process, user and system, in nanoseconds
+static uint64_t builtin_cpu_ns()
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
     {
-        BLAMMO(VERBOSE, "dry run routine linefunc");
         return 0;
     }
 
-    // put the raw line as-is in the routine.  variable substitutions
-    // and tokenization will occur later during routine execution.
-    routine->append(routine, line);
-    (void) scallop;
-
-    return 0;
+    return (uint64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+           1000000000ULL +
+           (uint64_t) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) *
+           1000ULL;
 }
 
 //------------------------------------------------------------------------|
-static int builtin_popfunc_routine(void * context,
-                                   void * object)
+// Run the rest of the line as a command and report what it cost.  The
+// command is executed directly rather than dispatched again, so its
+// arguments are not substituted twice.  Its result is passed through.
+static int builtin_handler_time(void * scmd,
+                                void * context,
+                                int argc,
+                                char ** args)
 {
     scallop_t * scallop = (scallop_t *) context;
-    scallop_rtn_t * routine = (scallop_rtn_t *) object;
+    console_t * console = scallop->console(scallop);
     scallop_cmd_t * cmds = scallop->commands(scallop);
+    scallop_cmd_t * cmd = NULL;
+    char elapsed_text[32];
+    int result = 0;
 
-    if (!routine)
+    if (argc < 2)
     {
-        BLAMMO(VERBOSE, "dry run routine popfunc");
-        return 0;
+        console->error(console, "expected a command to time");
+        return ERROR_MARKER_DEC;
     }
 
+    cmd = cmds->find_by_keyword(cmds, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "unknown command \'%s\'", args[1]);
+        return ERROR_MARKER_DEC;
+    }
 
-    bool success = true;
+    // Constructs span multiple lines, so time a routine instead
+    if (cmd->is_construct(cmd))
+    {
+        console->error(console, "cannot time construct \'%s\'", args[1]);
+        return ERROR_MARKER_DEC;
+    }
 
-    // All done defining this routine.  Now register it as a
-    // proper command.
-    scallop_cmd_t * cmd = cmds->create(
-            routine->handler,
-            scallop,
-            routine->name(routine),
-            " [argument-list]",
-            "user-registered routine");
+    size_t dispatches = scallop->dispatches(scallop);
+    long heap = builtin_heap_in_use();
+    uint64_t cpu = builtin_cpu_ns();
+    uint64_t wall = scallop_clock_ns();
 
-    // should be allowed to delete/modify routines
-    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_MUTABLE);
+    result = cmd->exec(cmd, argc - 1, &args[1]);
+
+    wall = scallop_clock_ns() - wall;
+    cpu = builtin_cpu_ns() - cpu;
+    heap = builtin_heap_in_use() - heap;
+    dispatches = scallop->dispatches(scallop) - dispatches;
 
-    success = cmds->register_cmd(cmds, cmd);
+    console->print(console,
+                   "time: wall %.3f ms, cpu %.3f ms, net heap %+ld bytes, "
+                   "%zu dispatches",
+                   wall / 1e6, cpu / 1e6, heap, dispatches);
 
-    return success ? 0 : -1;
+    // Leave the elapsed time where scripts can check it
+    snprintf(elapsed_text, sizeof(elapsed_text), "%llu",
+             (unsigned long long) wall);
+    scallop->assign_variable(scallop, "time_ns", elapsed_text);
+
+    return result;
 }
 
 //------------------------------------------------------------------------|
-// This routine performs the _definition_ of a routine.  Future incoming
-// lines will be handled by the 'routine' language construct's linefunc
-// callback.  Lines may come from the user interactively or from a script.
-// The actual _execution_ of a routine will occur later after the popfunc
-// is called and the routine is registered.
-static int builtin_handler_routine(void * scmd,
-                                   void * context,
-                                   int argc,
-                                   char ** args)
+static int builtin_handler_memo(void * scmd,
+                                void * context,
+                                int argc,
+                                char ** args)
 {
-    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
     scallop_t * scallop = (scallop_t *) context;
     console_t * console = scallop->console(scallop);
 
     if (argc < 2)
     {
-        console->error(console, "expected a routine name");
+        console->error(console, "expected a memo sub-command");
         return ERROR_MARKER_DEC;
     }
 
-    scallop_rtn_t * routine = NULL;
-    const char * routine_name = NULL;
-
-    // For dry run, do not create a routine object
-    if (cmd->is_dry_run(cmd))
+    // Find and execute subcommand
+    scallop_cmd_t * memo = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = memo->find_by_keyword(memo, args[1]);
+    if (!cmd)
     {
-        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+        console->error(console, "memo sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
     }
-    else
-    {
-        // Check if there is already a routine by the given name
-        routine = scallop->routine_by_name(scallop, args[1]);
-        if (routine)
-        {
-            console->error(console,
-                           "routine \'%s\' already exists",
-                           args[1]);
-            return ERROR_MARKER_DEC;
-        }
 
-        // Create a unique new routine object
-        routine = scallop->routine_insert(scallop, args[1]);
-        if (!routine)
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_memo_stats(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    chain_t * routines = (chain_t *) scallop->routines(scallop);
+    scallop_rtn_t * routine = NULL;
+    scallop_memo_t * memo = NULL;
+    size_t entries = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    int shown = 0;
+
+    // Report on every pure routine, or only the one asked for
+    routine = (scallop_rtn_t *) routines->first(routines);
+    while (routine)
+    {
+        memo = (scallop_memo_t *) routine->memo(routine);
+        if (memo && (argc < 2 || !strcmp(args[1], routine->name(routine))))
         {
-            console->error(console, "create routine \'%s\' failed", args[1]);
-            return ERROR_MARKER_DEC;
+            memo->stats(memo, &entries, &hits, &misses, &evictions);
+            console->print(console,
+                           "%s: entries %zu hits %zu misses %zu evictions %zu",
+                           routine->name(routine),
+                           entries,
+                           hits,
+                           misses,
+                           evictions);
+            shown++;
         }
 
-        routine_name = routine->name(routine);
+        routine = (scallop_rtn_t *) routines->next(routines);
     }
 
-    // Push the new routine definition onto the language construct
-    // stack.  This should get popped off when the matching 'end'
-    // statement is reached, and at THAT point it will become
-    // registered as a new command (with the ubiquitous routine handler)
-    // Until then, incoming lines will be added to the construct.
-    scallop->construct_push(scallop,
-                            routine_name,
-                            context,
-                            routine,
-                            builtin_linefunc_routine,
-                            builtin_popfunc_routine);
+    if (argc > 1 && shown == 0)
+    {
+        console->error(console, "pure routine %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
 
     return 0;
 }
 
 //------------------------------------------------------------------------|
-static int builtin_linefunc_while(void * context,
-                                  void * object,
-                                  const char * line)
+static int builtin_handler_memo_clear(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
 {
-    BLAMMO(VERBOSE, "");
-
     scallop_t * scallop = (scallop_t *) context;
-    scallop_whilex_t * whilex = (scallop_whilex_t *) object;
+    console_t * console = scallop->console(scallop);
+    chain_t * routines = (chain_t *) scallop->routines(scallop);
+    scallop_rtn_t * routine = NULL;
+    scallop_memo_t * memo = NULL;
+    int cleared = 0;
 
-    if (!whilex)
+    routine = (scallop_rtn_t *) routines->first(routines);
+    while (routine)
     {
-        BLAMMO(VERBOSE, "dry run while loop linefunc");
-        return 0;
+        memo = (scallop_memo_t *) routine->memo(routine);
+        if (memo && (argc < 2 || !strcmp(args[1], routine->name(routine))))
+        {
+            memo->clear(memo);
+            cleared++;
+        }
+
+        routine = (scallop_rtn_t *) routines->next(routines);
     }
 
-    // put the raw line as-is in the routine.  variable substitutions
-    // and tokenization will occur later during while execution.
-    whilex->append(whilex, line);
-    (void) scallop;
+    if (argc > 1 && cleared == 0)
+    {
+        console->error(console, "pure routine %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
 
     return 0;
 }
 
 //------------------------------------------------------------------------|
-// One approach considered was to create a special unregistered and
-// ephemeral command type, containing an object pointer, but this
-// approach is probably overly complicated when we have the object
-// right here as called from construct_pop.
-static int builtin_popfunc_while(void * context,
-                                 void * object)
+// Evaluate an argument down to the value to store, the same way 'assign'
+// does: numeric for anything that looks like an expression, else as-is.
+static bool builtin_value(console_t * console,
+                          const char * arg,
+                          bytes_t * value)
 {
-    scallop_whilex_t * whilex = (scallop_whilex_t *) object;
+    long result = 0;
 
-    // NOTE: During definition of a routine containing a while loop,
-    // this will have no lines to execute and the condition will exist
-    // but cannot be evaluated due to substitution not having occurred.
-    if (!whilex)
+    if (!sparser_is_expr(arg))
     {
-        BLAMMO(VERBOSE, "dry run while loop popfunc");
-        return 0;
+        value->assign(value, arg, strlen(arg));
+        return true;
     }
 
-    // For normal while loop in base context, the loop should NOW be
-    // executed (call the whilex->handler). Then, when it is finished,
-    // destroy it.  While loops are like immediate ephemeral functions,
-    // that don't take arguments.
-    int result = whilex->runner(whilex, context);
-
-    // While loop evaporates
-    whilex->destroy(whilex);
+    result = sparser_evaluate(console->error, console, arg);
+    if (result == SPARSER_INVALID_EXPRESSION)
+    {
+        console->error(console, "invalid expression \'%s\'", arg);
+        return false;
+    }
 
-    return result;
+    value->print(value, "%ld", result);
+    return true;
 }
 
 //------------------------------------------------------------------------|
-// while loops are shorter-lived constructs than routines.  They only
-// live inside the construct stack and evaporate when out of scope.
-static int builtin_handler_while(void * scmd,
-                                 void * context,
-                                 int argc,
-                                 char ** args)
+// Push each argument from args[first] onward onto a list
+static int builtin_list_push_args(console_t * console,
+                                  scallop_list_t * list,
+                                  int first,
+                                  int argc,
+                                  char ** args)
 {
-    BLAMMO(VERBOSE, "");
-
-    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
-    scallop_t * scallop = (scallop_t *) context;
-    console_t * console = scallop->console(scallop);
+    bytes_t * value = bytes_pub.create(NULL, 0);
+    int index = 0;
 
-    if (argc < 2)
+    for (index = first; index < argc; index++)
     {
-        console->error(console, "expected a conditional expression");
-        return ERROR_MARKER_DEC;
+        if (!builtin_value(console, args[index], value) ||
+            !list->push(list, value->cstr(value)))
+        {
+            value->destroy(value);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    value->destroy(value);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// Push each line of piped input onto a list, as it is
+static int builtin_list_push_input(console_t * console,
+                                   scallop_list_t * list,
+                                   scallop_stream_t * input)
+{
+    const char * line = NULL;
+
+    while ((line = input->read_line(input)) != NULL)
+    {
+        if (!list->push(list, line))
+        {
+            console->error(console, "list push failed");
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list(void * scmd,
+                                void * context,
+                                int argc,
+                                char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a list sub-command");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Find and execute subcommand
+    scallop_cmd_t * list = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = list->find_by_keyword(list, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "list sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list_create(void * scmd,
+                                       void * context,
+                                       int argc,
+                                       char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_stream_t * input = scallop->input(scallop);
+    scallop_list_t * list = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a list name");
+        return ERROR_MARKER_DEC;
+    }
+
+    list = scallop->list_insert(scallop, args[1]);
+    if (!list)
+    {
+        console->error(console, "create list \'%s\' failed", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (builtin_list_push_args(console, list, 2, argc, args) != 0)
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    return input ? builtin_list_push_input(console, list, input) : 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list_push(void * scmd,
+                                     void * context,
+                                     int argc,
+                                     char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_stream_t * input = scallop->input(scallop);
+    scallop_list_t * list = NULL;
+
+    if (argc < 2 || (argc < 3 && !input))
+    {
+        console->error(console, "expected a list name and value(s)");
+        return ERROR_MARKER_DEC;
+    }
+
+    list = scallop->list_by_name(scallop, args[1]);
+    if (!list)
+    {
+        console->error(console, "list \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (builtin_list_push_args(console, list, 2, argc, args) != 0)
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    return input ? builtin_list_push_input(console, list, input) : 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list_pop(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_list_t * list = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a list name");
+        return ERROR_MARKER_DEC;
+    }
+
+    list = scallop->list_by_name(scallop, args[1]);
+    if (!list)
+    {
+        console->error(console, "list \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (list->length(list) == 0)
+    {
+        console->error(console, "list \'%s\' is empty", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    // Optionally keep the popped item in a variable
+    if (argc > 2 &&
+        !scallop->assign_variable(scallop, args[2], list->get(list, -1)))
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    list->pop(list);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list_set(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_list_t * list = NULL;
+    bytes_t * value = NULL;
+    char * end = NULL;
+    long index = 0;
+    int result = 0;
+
+    if (argc < 4)
+    {
+        console->error(console, "expected a list name, index and value");
+        return ERROR_MARKER_DEC;
+    }
+
+    list = scallop->list_by_name(scallop, args[1]);
+    if (!list)
+    {
+        console->error(console, "list \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    index = strtol(args[2], &end, 0);
+    if (end == args[2] || *end != '\0')
+    {
+        console->error(console, "invalid index \'%s\'", args[2]);
+        return ERROR_MARKER_DEC;
+    }
+
+    value = bytes_pub.create(NULL, 0);
+    if (!builtin_value(console, args[3], value))
+    {
+        result = ERROR_MARKER_DEC;
+    }
+    else if (!list->set(list, index, value->cstr(value)))
+    {
+        console->error(console,
+                       "index %ld out of range for list \'%s\'",
+                       index,
+                       args[1]);
+        result = ERROR_MARKER_DEC;
+    }
+
+    value->destroy(value);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// The length is the result, as seen in "%?"
+static int builtin_handler_list_length(void * scmd,
+                                       void * context,
+                                       int argc,
+                                       char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_list_t * list = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a list name");
+        return ERROR_MARKER_DEC;
+    }
+
+    list = scallop->list_by_name(scallop, args[1]);
+    if (!list)
+    {
+        console->error(console, "list \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return (int) list->length(list);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_list_delete(void * scmd,
+                                       void * context,
+                                       int argc,
+                                       char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a list name");
+        return ERROR_MARKER_DEC;
+    }
+
+    if (!scallop->list_by_name(scallop, args[1]))
+    {
+        console->error(console, "list \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    scallop->list_remove(scallop, args[1]);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_map(void * scmd,
+                               void * context,
+                               int argc,
+                               char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a map sub-command");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Find and execute subcommand
+    scallop_cmd_t * map = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = map->find_by_keyword(map, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "map sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+// Maps are created on first use
+static int builtin_handler_map_set(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_map_t * map = NULL;
+    bytes_t * value = NULL;
+    int result = 0;
+
+    if (argc < 4)
+    {
+        console->error(console, "expected a map name, key and value");
+        return ERROR_MARKER_DEC;
+    }
+
+    map = scallop->map_by_name(scallop, args[1]);
+    if (!map)
+    {
+        map = scallop->map_insert(scallop, args[1]);
+        if (!map)
+        {
+            console->error(console, "create map \'%s\' failed", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    value = bytes_pub.create(NULL, 0);
+    if (!builtin_value(console, args[3], value) ||
+        !map->set(map, args[2], value->cstr(value)))
+    {
+        result = ERROR_MARKER_DEC;
+    }
+
+    value->destroy(value);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_map_get(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_map_t * map = NULL;
+    const char * value = NULL;
+
+    if (argc < 4)
+    {
+        console->error(console, "expected a map name, key and variable name");
+        return ERROR_MARKER_DEC;
+    }
+
+    map = scallop->map_by_name(scallop, args[1]);
+    if (!map)
+    {
+        console->error(console, "map \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    value = map->get(map, args[2]);
+    if (!value)
+    {
+        console->error(console,
+                       "key \'%s\' not found in map \'%s\'",
+                       args[2],
+                       args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return scallop->assign_variable(scallop, args[3], value) ?
+            0 : ERROR_MARKER_DEC;
+}
+
+//------------------------------------------------------------------------|
+// Without a key, the whole map goes
+static int builtin_handler_map_del(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_map_t * map = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a map name");
+        return ERROR_MARKER_DEC;
+    }
+
+    map = scallop->map_by_name(scallop, args[1]);
+    if (!map)
+    {
+        console->error(console, "map \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (argc < 3)
+    {
+        scallop->map_remove(scallop, args[1]);
+    }
+    else if (!map->remove(map, args[2]))
+    {
+        console->error(console,
+                       "key \'%s\' not found in map \'%s\'",
+                       args[2],
+                       args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_compare_keys(const void * first, const void * second)
+{
+    return strcmp(*(const char * const *) first,
+                  *(const char * const *) second);
+}
+
+//------------------------------------------------------------------------|
+// Keys are put in a list in sorted order, for repeatable scripts
+static int builtin_handler_map_keys(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_map_t * map = NULL;
+    scallop_list_t * list = NULL;
+    const char ** keys = NULL;
+    const char * value = NULL;
+    size_t cursor = 0;
+    size_t count = 0;
+    size_t index = 0;
+    int result = 0;
+
+    if (argc < 3)
+    {
+        console->error(console, "expected a map name and list name");
+        return ERROR_MARKER_DEC;
+    }
+
+    map = scallop->map_by_name(scallop, args[1]);
+    if (!map)
+    {
+        console->error(console, "map \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    keys = (const char **) malloc((map->size(map) + 1) * sizeof(*keys));
+    if (!keys)
+    {
+        console->error(console, "out of memory listing map \'%s\'", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    while (map->next(map, &cursor, &keys[count], &value))
+    {
+        count++;
+    }
+
+    qsort(keys, count, sizeof(*keys), builtin_compare_keys);
+
+    list = scallop->list_insert(scallop, args[2]);
+    for (index = 0; list && index < count; index++)
+    {
+        if (!list->push(list, keys[index]))
+        {
+            list = NULL;
+        }
+    }
+
+    if (!list)
+    {
+        console->error(console, "create list \'%s\' failed", args[2]);
+        result = ERROR_MARKER_DEC;
+    }
+
+    free(keys);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// The number of keys is the result, as seen in "%?"
+static int builtin_handler_map_size(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_map_t * map = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a map name");
+        return ERROR_MARKER_DEC;
+    }
+
+    map = scallop->map_by_name(scallop, args[1]);
+    if (!map)
+    {
+        console->error(console, "map \'%s\' not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return (int) map->size(map);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a profile sub-command");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Find and execute subcommand
+    scallop_cmd_t * profile = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = profile->find_by_keyword(profile, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "profile sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile_on(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
+{
+    scallop_cmd_pub.set_profiling(true);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile_off(void * scmd,
+                                       void * context,
+                                       int argc,
+                                       char ** args)
+{
+    scallop_cmd_pub.set_profiling(false);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile_reset(void * scmd,
+                                         void * context,
+                                         int argc,
+                                         char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    chain_t * routines = (chain_t *) scallop->routines(scallop);
+    scallop_rtn_t * routine = NULL;
+    scallop_lines_t * lines = NULL;
+
+    cmds->reset_stats(cmds);
+
+    routine = (scallop_rtn_t *) routines->first(routines);
+    while (routine)
+    {
+        lines = (scallop_lines_t *) routine->lines(routine);
+        lines->reset_stats(lines);
+        routine = (scallop_rtn_t *) routines->next(routines);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// Annotated listing of one routine body: each line with its hit count
+// and share of the time spent in the routine.  Lines inside loops and
+// if-else blocks are counted each time they run, and the line closing
+// such a block is charged for all of it.
+static void builtin_profile_listing(scallop_t * scallop,
+                                    scallop_rtn_t * routine)
+{
+    console_t * console = scallop->console(scallop);
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    scallop_cmd_t * cmd = cmds->find_by_keyword(cmds, routine->name(routine));
+    scallop_lines_t * lines = (scallop_lines_t *) routine->lines(routine);
+    scallop_lines_stats_t * stats = NULL;
+    size_t count = lines->count(lines);
+    uint64_t total_ns = cmd ? cmd->stats(cmd)->total_ns : 0;
+    size_t index = 0;
+
+    console->print(console, "routine %s: %zu calls %.3f ms",
+                   routine->name(routine),
+                   cmd ? cmd->stats(cmd)->calls : 0,
+                   total_ns / 1e6);
+    console->print(console, "%10s %12s %7s  %s",
+                   "hits", "total-ms", "share", "line");
+
+    for (index = 0; index < count; index++)
+    {
+        stats = lines->stats(lines, index);
+        if (!stats)
+        {
+            return;
+        }
+
+        console->print(console, "%10zu %12.3f %6.1f%%  %s",
+                       stats->hits,
+                       stats->total_ns / 1e6,
+                       total_ns ? 100.0 * stats->total_ns / total_ns : 0.0,
+                       lines->line(lines, index));
+    }
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile_listing(void * scmd,
+                                           void * context,
+                                           int argc,
+                                           char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    chain_t * routines = (chain_t *) scallop->routines(scallop);
+    scallop_rtn_t * routine = NULL;
+    scallop_lines_t * lines = NULL;
+    scallop_lines_stats_t * stats = NULL;
+
+    if (argc > 1)
+    {
+        routine = scallop->routine_by_name(scallop, args[1]);
+        if (!routine)
+        {
+            console->error(console, "routine %s not found", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+
+        builtin_profile_listing(scallop, routine);
+        return 0;
+    }
+
+    // Without a name, list every routine that has been run
+    routine = (scallop_rtn_t *) routines->first(routines);
+    while (routine)
+    {
+        lines = (scallop_lines_t *) routine->lines(routine);
+        stats = lines->stats(lines, 0);
+        if (stats && stats->hits > 0)
+        {
+            builtin_profile_listing(scallop, routine);
+        }
+
+        routine = (scallop_rtn_t *) routines->next(routines);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// One line of the profile report
+typedef struct
+{
+    char * path;
+    scallop_cmd_stats_t stats;
+}
+builtin_profile_entry_t;
+
+typedef struct
+{
+    builtin_profile_entry_t * entries;
+    size_t count;
+    size_t capacity;
+}
+builtin_profile_report_t;
+
+//------------------------------------------------------------------------|
+static void builtin_profile_collect(void * object,
+                                    const char * path,
+                                    const scallop_cmd_stats_t * stats)
+{
+    builtin_profile_report_t * report = (builtin_profile_report_t *) object;
+    builtin_profile_entry_t * entries = NULL;
+    size_t capacity = 0;
+
+    if (report->count == report->capacity)
+    {
+        capacity = report->capacity ? 2 * report->capacity : 32;
+        entries = (builtin_profile_entry_t *)
+                realloc(report->entries, capacity * sizeof(*entries));
+        if (!entries)
+        {
+            BLAMMO(ERROR, "realloc(%zu) failed", capacity * sizeof(*entries));
+            return;
+        }
+
+        report->entries = entries;
+        report->capacity = capacity;
+    }
+
+    report->entries[report->count].path = strdup(path);
+    report->entries[report->count].stats = *stats;
+    if (report->entries[report->count].path)
+    {
+        report->count++;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Most total time first
+static int builtin_profile_compare(const void * first, const void * second)
+{
+    const builtin_profile_entry_t * a = (const builtin_profile_entry_t *) first;
+    const builtin_profile_entry_t * b = (const builtin_profile_entry_t *) second;
+
+    if (a->stats.total_ns != b->stats.total_ns)
+    {
+        return a->stats.total_ns < b->stats.total_ns ? 1 : -1;
+    }
+
+    return strcmp(a->path, b->path);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_profile_show(void * scmd,
+                                        void * context,
+                                        int argc,
+                                        char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    builtin_profile_report_t report;
+    builtin_profile_entry_t * entry = NULL;
+    size_t index = 0;
+
+    memzero(&report, sizeof(report));
+    cmds->each_stats(cmds, NULL, builtin_profile_collect, &report);
+    qsort(report.entries, report.count, sizeof(*report.entries),
+          builtin_profile_compare);
+
+    console->print(console, "%10s %8s %12s %12s %12s  %s",
+                   "calls", "errors", "total-ms", "avg-us", "max-us",
+                   "command");
+
+    for (index = 0; index < report.count; index++)
+    {
+        entry = &report.entries[index];
+        console->print(console, "%10zu %8zu %12.3f %12.3f %12.3f  %s",
+                       entry->stats.calls,
+                       entry->stats.errors,
+                       entry->stats.total_ns / 1e6,
+                       entry->stats.total_ns / 1e3 / entry->stats.calls,
+                       entry->stats.max_ns / 1e3,
+                       entry->path);
+        free(entry->path);
+    }
+
+    if (!scallop_cmd_pub.is_profiling())
+    {
+        console->print(console, "(profiling is off)");
+    }
+
+    free(report.entries);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_trace(void * scmd,
+                                 void * context,
+                                 int argc,
+                                 char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a trace sub-command");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Find and execute subcommand
+    scallop_cmd_t * trace = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = trace->find_by_keyword(trace, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "trace sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_trace_start(void * scmd,
+                                       void * context,
+                                       int argc,
+                                       char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    long capacity = 0;
+
+    if (argc > 1)
+    {
+        if (!scallop->evaluate_value(scallop, args[1], strlen(args[1]),
+                                     &capacity))
+        {
+            return ERROR_MARKER_DEC;
+        }
+
+        if (capacity <= 0)
+        {
+            console->error(console, "trace capacity must be positive");
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    if (!scallop->trace_start(scallop, (size_t) capacity))
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_trace_stop(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    scallop->trace_stop(scallop);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_trace_dump(void * scmd,
+                                      void * context,
+                                      int argc,
+                                      char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a file name");
+        return ERROR_MARKER_DEC;
+    }
+
+    if (!scallop->trace_dump(scallop, args[1]))
+    {
+        console->error(console, "could not dump trace to %s", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_flush(void * scmd,
+                                 void * context,
+                                 int argc,
+                                 char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    scallop->flush_output(scallop);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_snapshot(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a snapshot sub-command");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Find and execute subcommand
+    scallop_cmd_t * snapshot = (scallop_cmd_t *) scmd;
+    scallop_cmd_t * cmd = snapshot->find_by_keyword(snapshot, args[1]);
+    if (!cmd)
+    {
+        console->error(console, "snapshot sub-command %s not found", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return cmd->exec(cmd, --argc, &args[1]);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_snapshot_save(void * scmd,
+                                         void * context,
+                                         int argc,
+                                         char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a file name");
+        return ERROR_MARKER_DEC;
+    }
+
+    if (!scallop_snapshot_save(scallop, args[1]))
+    {
+        console->error(console, "could not save snapshot to %s", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_snapshot_load(void * scmd,
+                                         void * context,
+                                         int argc,
+                                         char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    int failed = 0;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a file name");
+        return ERROR_MARKER_DEC;
+    }
+
+    failed = scallop_snapshot_load(scallop, args[1]);
+    if (failed < 0)
+    {
+        console->error(console, "could not load snapshot from %s", args[1]);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (failed > 0)
+    {
+        console->error(console,
+                       "%d routines or aliases already defined, not loaded",
+                       failed);
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_linefunc_routine(void * context,
+                                    void * object,
+                                    const char * line)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    scallop_rtn_t * routine = (scallop_rtn_t *) object;
+
+    if (!routine)
+    {
+        BLAMMO(VERBOSE, "dry run routine linefunc");
+        return 0;
+    }
+
+    // put the raw line as-is in the routine.  variable substitutions
+    // and tokenization will occur later during routine execution.
+    routine->append(routine, line);
+    (void) scallop;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+bool register_routine_command(void * scallop_ptr, void * routine_ptr)
+{
+    scallop_t * scallop = (scallop_t *) scallop_ptr;
+    scallop_rtn_t * routine = (scallop_rtn_t *) routine_ptr;
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+
+    scallop_cmd_t * cmd = cmds->create(
+            routine->handler,
+            scallop,
+            routine->name(routine),
+            " [argument-list]",
+            "user-registered routine");
+
+    // should be allowed to delete/modify routines
+    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_MUTABLE);
+
+    return cmds->register_cmd(cmds, cmd);
+}
+
+//------------------------------------------------------------------------|
+static int builtin_popfunc_routine(void * context,
+                                   void * object)
+{
+    scallop_rtn_t * routine = (scallop_rtn_t *) object;
+
+    if (!routine)
+    {
+        BLAMMO(VERBOSE, "dry run routine popfunc");
+        return 0;
+    }
+
+    // All done defining this routine.  Now register it as a
+    // proper command.
+    return register_routine_command(context, routine) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------|
+// This routine performs the _definition_ of a routine.  Future incoming
+// lines will be handled by the 'routine' language construct's linefunc
+// callback.  Lines may come from the user interactively or from a script.
+// The actual _execution_ of a routine will occur later after the popfunc
+// is called and the routine is registered.
+static int builtin_handler_routine(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a routine name");
+        return ERROR_MARKER_DEC;
+    }
+
+    scallop_rtn_t * routine = NULL;
+    const char * routine_name = NULL;
+
+    // 'routine pure <name>' declares a routine whose result depends only
+    // on its arguments, so that its results can be memoized.  A routine
+    // may still be named 'pure' as long as nothing follows it.
+    bool pure = (argc > 2) && !strcmp(args[1], "pure");
+    const char * name = pure ? args[2] : args[1];
+
+    // For dry run, do not create a routine object
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+    }
+    else
+    {
+        // Check if there is already a routine by the given name
+        routine = scallop->routine_by_name(scallop, name);
+        if (routine)
+        {
+            console->error(console,
+                           "routine \'%s\' already exists",
+                           name);
+            return ERROR_MARKER_DEC;
+        }
+
+        // Create a unique new routine object
+        routine = scallop->routine_insert(scallop, name);
+        if (!routine)
+        {
+            console->error(console, "create routine \'%s\' failed", name);
+            return ERROR_MARKER_DEC;
+        }
+
+        if (pure && !routine->set_pure(routine, true))
+        {
+            console->error(console, "declare routine \'%s\' pure failed", name);
+            scallop->routine_remove(scallop, name);
+            return ERROR_MARKER_DEC;
+        }
+
+        routine_name = routine->name(routine);
+    }
+
+    // Push the new routine definition onto the language construct
+    // stack.  This should get popped off when the matching 'end'
+    // statement is reached, and at THAT point it will become
+    // registered as a new command (with the ubiquitous routine handler)
+    // Until then, incoming lines will be added to the construct.
+    scallop->construct_push(scallop,
+                            routine_name,
+                            context,
+                            routine,
+                            builtin_linefunc_routine,
+                            builtin_popfunc_routine);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_linefunc_while(void * context,
+                                  void * object,
+                                  const char * line)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_t * scallop = (scallop_t *) context;
+    scallop_whilex_t * whilex = (scallop_whilex_t *) object;
+
+    if (!whilex)
+    {
+        BLAMMO(VERBOSE, "dry run while loop linefunc");
+        return 0;
+    }
+
+    // put the raw line as-is in the routine.  variable substitutions
+    // and tokenization will occur later during while execution.
+    whilex->append(whilex, line);
+    (void) scallop;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// One approach considered was to create a special unregistered and
+// ephemeral command type, containing an object pointer, but this
+// approach is probably overly complicated when we have the object
+// right here as called from construct_pop.
+static int builtin_popfunc_while(void * context,
+                                 void * object)
+{
+    scallop_whilex_t * whilex = (scallop_whilex_t *) object;
+
+    // NOTE: During definition of a routine containing a while loop,
+    // this will have no lines to execute and the condition will exist
+    // but cannot be evaluated due to substitution not having occurred.
+    if (!whilex)
+    {
+        BLAMMO(VERBOSE, "dry run while loop popfunc");
+        return 0;
+    }
+
+    // For normal while loop in base context, the loop should NOW be
+    // executed (call the whilex->handler). Then, when it is finished,
+    // destroy it.  While loops are like immediate ephemeral functions,
+    // that don't take arguments.
+    int result = whilex->runner(whilex, context);
+
+    // While loop evaporates
+    whilex->destroy(whilex);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// while loops are shorter-lived constructs than routines.  They only
+// live inside the construct stack and evaporate when out of scope.
+static int builtin_handler_while(void * scmd,
+                                 void * context,
+                                 int argc,
+                                 char ** args)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a conditional expression");
+        return ERROR_MARKER_DEC;
     }
 
     // Create a while loop construct
@@ -767,6 +2119,181 @@ static int builtin_handler_while(void * scmd,
     return 0;
 }
 
+//------------------------------------------------------------------------|
+static int builtin_linefunc_for(void * context,
+                                void * object,
+                                const char * line)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_forx_t * forx = (scallop_forx_t *) object;
+
+    if (!forx)
+    {
+        BLAMMO(VERBOSE, "dry run for loop linefunc");
+        return 0;
+    }
+
+    // raw line as-is, substitution happens on each iteration
+    forx->append(forx, line);
+    (void) context;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_popfunc_for(void * context,
+                               void * object)
+{
+    scallop_forx_t * forx = (scallop_forx_t *) object;
+
+    if (!forx)
+    {
+        BLAMMO(VERBOSE, "dry run for loop popfunc");
+        return 0;
+    }
+
+    // Like while loops, run immediately and then evaporate
+    int result = forx->runner(forx, context);
+    forx->destroy(forx);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// for loops are ephemeral constructs, exactly like while loops
+static int builtin_handler_for(void * scmd,
+                               void * context,
+                               int argc,
+                               char ** args)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_forx_t * forx = NULL;
+
+    if (argc < 4)
+    {
+        console->error(console, "expected <var-name> <start> <end> [step]");
+        return ERROR_MARKER_DEC;
+    }
+
+    // For dry run, do not create a for loop object
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+    }
+    else
+    {
+        forx = scallop_forx_pub.create(args[1],
+                                       args[2],
+                                       args[3],
+                                       argc > 4 ? args[4] : NULL);
+        if (!forx)
+        {
+            console->error(console, "create for \'%s\' failed", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    scallop->construct_push(scallop,
+        "for",
+        context,
+        forx,
+        builtin_linefunc_for,
+        builtin_popfunc_for);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_linefunc_foreach(void * context,
+                                    void * object,
+                                    const char * line)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_foreachx_t * foreachx = (scallop_foreachx_t *) object;
+
+    if (!foreachx)
+    {
+        BLAMMO(VERBOSE, "dry run foreach loop linefunc");
+        return 0;
+    }
+
+    // raw line as-is, substitution happens on each iteration
+    foreachx->append(foreachx, line);
+    (void) context;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_popfunc_foreach(void * context,
+                                   void * object)
+{
+    scallop_foreachx_t * foreachx = (scallop_foreachx_t *) object;
+
+    if (!foreachx)
+    {
+        BLAMMO(VERBOSE, "dry run foreach loop popfunc");
+        return 0;
+    }
+
+    // Like while loops, run immediately and then evaporate
+    int result = foreachx->runner(foreachx, context);
+    foreachx->destroy(foreachx);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// foreach loops are ephemeral constructs, exactly like while loops
+static int builtin_handler_foreach(void * scmd,
+                                   void * context,
+                                   int argc,
+                                   char ** args)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_foreachx_t * foreachx = NULL;
+
+    if (argc < 3)
+    {
+        console->error(console, "expected <var-name> <list-name>");
+        return ERROR_MARKER_DEC;
+    }
+
+    // For dry run, do not create a foreach loop object
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+    }
+    else
+    {
+        foreachx = scallop_foreachx_pub.create(args[1], args[2]);
+        if (!foreachx)
+        {
+            console->error(console, "create foreach \'%s\' failed", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    scallop->construct_push(scallop,
+        "foreach",
+        context,
+        foreachx,
+        builtin_linefunc_foreach,
+        builtin_popfunc_foreach);
+
+    return 0;
+}
+
 //------------------------------------------------------------------------|
 static int builtin_linefunc_if(void * context,
                                void * object,
@@ -823,44 +2350,227 @@ static int builtin_handler_if(void * scmd,
     scallop_t * scallop = (scallop_t *) context;
     console_t * console = scallop->console(scallop);
 
-    if (argc < 2)
-    {
-        console->error(console, "expected a conditional expression");
-        return ERROR_MARKER_DEC;
+    if (argc < 2)
+    {
+        console->error(console, "expected a conditional expression");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Create an if-else construct
+    scallop_ifelse_t * ifelse = NULL;
+
+    // For dry run, do not create a while loop object
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+    }
+    else
+    {
+        ifelse = scallop_ifelse_pub.create(args[1]);
+        if (!ifelse)
+        {
+            console->error(console, "create ifelse \'%s\' failed", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    scallop->construct_push(scallop,
+        "if-else",                // TODO: Consider names for ifelse???
+        context,
+        ifelse,
+        builtin_linefunc_if,
+        builtin_popfunc_if);
+
+    return 0;
+}
+
+
+//------------------------------------------------------------------------|
+static int builtin_linefunc_switch(void * context,
+                                   void * object,
+                                   const char * line)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_switchx_t * switchx = (scallop_switchx_t *) object;
+
+    if (!switchx)
+    {
+        BLAMMO(VERBOSE, "dry run switch linefunc");
+        return 0;
+    }
+
+    switchx->append(switchx, line);
+    (void) context;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_popfunc_switch(void * context,
+                                  void * object)
+{
+    scallop_switchx_t * switchx = (scallop_switchx_t *) object;
+
+    if (!switchx)
+    {
+        BLAMMO(VERBOSE, "dry run switch popfunc");
+        return 0;
+    }
+
+    int result = switchx->runner(switchx, context);
+
+    // Switch evaporates, like if-else
+    switchx->destroy(switchx);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// switch statements are short-lived like if-else.
+static int builtin_handler_switch(void * scmd,
+                                  void * context,
+                                  int argc,
+                                  char ** args)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_switchx_t * switchx = NULL;
+
+    if (argc < 2)
+    {
+        console->error(console, "expected a numeric expression");
+        return ERROR_MARKER_DEC;
+    }
+
+    // For dry run, do not create a switch object
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+    }
+    else
+    {
+        switchx = scallop_switchx_pub.create(args[1]);
+        if (!switchx)
+        {
+            console->error(console, "create switch \'%s\' failed", args[1]);
+            return ERROR_MARKER_DEC;
+        }
+    }
+
+    scallop->construct_push(scallop,
+        "switch",
+        context,
+        switchx,
+        builtin_linefunc_switch,
+        builtin_popfunc_switch);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// 'case' modifies the existing construct declaration like 'else' does,
+// starting a new arm of a switch.  Labels are resolved here, once, as
+// the switch is declared.
+static int builtin_handler_case(void * scmd,
+                                void * context,
+                                int argc,
+                                char ** args)
+{
+    BLAMMO(VERBOSE, "");
+
+    scallop_cmd_t * cmd = (scallop_cmd_t *) scmd;
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    char * end = NULL;
+    long label = 0;
+    int index = 0;
+    int other = 0;
+
+    if (cmd->is_dry_run(cmd))
+    {
+        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+        return 0;
+    }
+
+    // The construct's name tells what kind of object it is
+    const char * name = scallop->construct_name(scallop);
+    scallop_switchx_t * switchx = (scallop_switchx_t *)
+            scallop->construct_object(scallop);
+    if (!switchx || !name || strcmp(name, "switch"))
+    {
+        console->error(console, "case without switch construct");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Whatever follows a rejected case must not run as part of the arm
+    // before it.  Starting the new arm opens the switch again.
+    switchx->close_arm(switchx);
+
+    if (argc < 2)
+    {
+        console->error(console, "expected one or more case labels");
+        return ERROR_MARKER_DEC;
+    }
+
+    if (switchx->has_default(switchx))
+    {
+        console->error(console, "case after else in switch");
+        return ERROR_MARKER_DEC;
+    }
+
+    // Check every label before starting the arm, so that a bad one
+    // leaves the switch as it was
+    for (index = 1; index < argc; index++)
+    {
+        label = strtol(args[index], &end, 0);
+        if (end == args[index] || *end != '\0')
+        {
+            console->error(console, "invalid case label \'%s\'", args[index]);
+            return ERROR_MARKER_DEC;
+        }
+
+        // Labels are parsed again rather than kept, as there are few
+        for (other = 1; other < index; other++)
+        {
+            if (strtol(args[other], NULL, 0) == label)
+            {
+                break;
+            }
+        }
+
+        if (other < index || switchx->has_label(switchx, label))
+        {
+            console->error(console, "duplicate case label \'%s\'", args[index]);
+            return ERROR_MARKER_DEC;
+        }
     }
 
-    // Create an if-else construct
-    scallop_ifelse_t * ifelse = NULL;
-
-    // For dry run, do not create a while loop object
-    if (cmd->is_dry_run(cmd))
+    if (!switchx->new_arm(switchx))
     {
-        cmd->clear_attributes(cmd, SCALLOP_CMD_ATTR_DRY_RUN);
+        console->error(console, "failed to add case \'%s\'", args[1]);
+        return ERROR_MARKER_DEC;
     }
-    else
+
+    for (index = 1; index < argc; index++)
     {
-        ifelse = scallop_ifelse_pub.create(args[1]);
-        if (!ifelse)
+        if (!switchx->add_label(switchx, strtol(args[index], NULL, 0)))
         {
-            console->error(console, "create ifelse \'%s\' failed", args[1]);
+            console->error(console, "failed to add case label \'%s\'", args[index]);
             return ERROR_MARKER_DEC;
         }
     }
 
-    scallop->construct_push(scallop,
-        "if-else",                // TODO: Consider names for ifelse???
-        context,
-        ifelse,
-        builtin_linefunc_if,
-        builtin_popfunc_if);
-
     return 0;
 }
 
-
 //------------------------------------------------------------------------|
 // 'else' is a special command keyword, in that it modifies the existing
-// construct declaration (assuming it's an if-else!)
+// construct declaration.  That may be an if-else, or the default arm of
+// a switch.
 static int builtin_handler_else(void * scmd,
                                 void * context,
                                 int argc,
@@ -878,9 +2588,23 @@ static int builtin_handler_else(void * scmd,
         return 0;
     }
 
-    scallop_ifelse_t * ifelse = (scallop_ifelse_t *)
-            scallop->construct_object(scallop);
-    if (!ifelse)
+    const char * name = scallop->construct_name(scallop);
+    void * object = scallop->construct_object(scallop);
+    scallop_ifelse_t * ifelse = (scallop_ifelse_t *) object;
+    scallop_switchx_t * switchx = (scallop_switchx_t *) object;
+
+    if (switchx && name && !strcmp(name, "switch"))
+    {
+        if (!switchx->default_arm(switchx))
+        {
+            console->error(console, "switch already has an else");
+            return ERROR_MARKER_DEC;
+        }
+
+        return 0;
+    }
+
+    if (!ifelse || !name || strcmp(name, "if-else"))
     {
         console->error(console, "else without if construct");
         return ERROR_MARKER_DEC;
@@ -901,6 +2625,90 @@ static int builtin_handler_end(void * scmd,
     return scallop->construct_pop(scallop);
 }
 
+//------------------------------------------------------------------------|
+static int builtin_handler_break(void * scmd,
+                                 void * context,
+                                 int argc,
+                                 char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (!scallop->unwind(scallop, SCALLOP_UNWIND_BREAK))
+    {
+        console->error(console, "break outside of a loop");
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int builtin_handler_continue(void * scmd,
+                                    void * context,
+                                    int argc,
+                                    char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+
+    if (!scallop->unwind(scallop, SCALLOP_UNWIND_CONTINUE))
+    {
+        console->error(console, "continue outside of a loop");
+        return ERROR_MARKER_DEC;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// The value returned becomes the routine's result, since dispatch stores
+// it in "%?" and run_lines() hands the last result back to the caller.
+static int builtin_handler_return(void * scmd,
+                                  void * context,
+                                  int argc,
+                                  char ** args)
+{
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    long result = 0;
+    char * end = NULL;
+
+    if (argc > 1)
+    {
+        if (sparser_is_expr(args[1]))
+        {
+            result = sparser_evaluate(console->error, console, args[1]);
+            if (result == SPARSER_INVALID_EXPRESSION)
+            {
+                console->error(console,
+                               "invalid return expression \'%s\'",
+                               args[1]);
+                return ERROR_MARKER_DEC;
+            }
+        }
+        else
+        {
+            result = strtol(args[1], &end, 0);
+            if (end == args[1] || *end)
+            {
+                console->error(console,
+                               "return value \'%s\' is not numeric",
+                               args[1]);
+                return ERROR_MARKER_DEC;
+            }
+        }
+    }
+
+    if (!scallop->unwind(scallop, SCALLOP_UNWIND_RETURN))
+    {
+        console->error(console, "return outside of a routine");
+        return ERROR_MARKER_DEC;
+    }
+
+    return (int) result;
+}
+
 //------------------------------------------------------------------------|
 static int builtin_handler_quit(void * scmd,
                                 void * context,
@@ -998,6 +2806,22 @@ bool register_builtin_commands(void * scallop_ptr)
         " <log-file-path>",
         "change the blammo log file path"));
 
+    // CORE
+    success &= log->register_cmd(log, log->create(
+        builtin_handler_log_ring,
+        scallop,
+        "ring",
+        " <file-path>",
+        "write out and clear the ring-buffer log, as text"));
+
+    // CORE
+    success &= log->register_cmd(log, log->create(
+        builtin_handler_log_stream,
+        scallop,
+        "stream",
+        " [file-path]",
+        "append ring-buffer log entries to a file as they happen, or stop"));
+
 
     // CORE
     scallop_cmd_t * plugin = cmds->create(
@@ -1043,7 +2867,7 @@ bool register_builtin_commands(void * scallop_ptr)
         scallop,
         "print",
         " [arbitrary-expression(s)]",
-        "print expressions, strings, and variables"));
+        "print expressions, strings, and variables, or lines piped in"));
 
     // BASE LANGUAGE - MARGINAL
     // Will need to be CORE in order to run general script
@@ -1056,6 +2880,15 @@ bool register_builtin_commands(void * scallop_ptr)
         " <script-path>",
         "load and run a command script"));
 
+    // BASE LANGUAGE
+    success &= cmds->register_cmd(cmds, cmds->create(
+        builtin_handler_time,
+        scallop,
+        "time",
+        " <command> [args ...]",
+        "run a command, report time, net heap bytes (in use after less "
+        "before) and dispatches, store ns in {time_ns}"));
+
     /////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////
@@ -1066,8 +2899,8 @@ bool register_builtin_commands(void * scallop_ptr)
         builtin_handler_assign,
         scallop,
         "assign",
-        " <var-name> <value>",
-        "assign a value to a variable"));
+        " <var-name> [value]",
+        "assign a value, or lines piped in, to a variable"));
 
 
     // BASE LANGUAGE
@@ -1075,11 +2908,263 @@ bool register_builtin_commands(void * scallop_ptr)
         builtin_handler_routine,
         scallop,
         "routine",
-        " <routine-name> ...",
+        " [pure] <routine-name> ...",
         "define and register a new routine");
     cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_PUSH);
     success &= cmds->register_cmd(cmds, cmd);
 
+    // BASE LANGUAGE
+    scallop_cmd_t * memo = cmds->create(
+        builtin_handler_memo,
+        scallop,
+        "memo",
+        " <memo-command> <...>",
+        "inspect or clear pure routine result caches");
+
+    success &= cmds->register_cmd(cmds, memo);
+
+    // BASE LANGUAGE
+    success &= memo->register_cmd(memo, memo->create(
+        builtin_handler_memo_stats,
+        scallop,
+        "stats",
+        " [routine-name]",
+        "show cache entries, hits, misses and evictions"));
+
+    // BASE LANGUAGE
+    success &= memo->register_cmd(memo, memo->create(
+        builtin_handler_memo_clear,
+        scallop,
+        "clear",
+        " [routine-name]",
+        "discard cached results"));
+
+    // BASE LANGUAGE
+    scallop_cmd_t * list = cmds->create(
+        builtin_handler_list,
+        scallop,
+        "list",
+        " <list-command> <...>",
+        "create and modify list variables, referenced as {name[index]}");
+
+    success &= cmds->register_cmd(cmds, list);
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_create,
+        scallop,
+        "create",
+        " <list-name> [value ...]",
+        "create or replace a list with the given items and lines piped in"));
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_push,
+        scallop,
+        "push",
+        " <list-name> [value ...]",
+        "append items and lines piped in to the end of a list"));
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_pop,
+        scallop,
+        "pop",
+        " <list-name> [var-name]",
+        "remove the last item, optionally assigning it"));
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_set,
+        scallop,
+        "set",
+        " <list-name> <index> <value>",
+        "replace the item at an index"));
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_length,
+        scallop,
+        "length",
+        " <list-name>",
+        "result is the number of items"));
+
+    // BASE LANGUAGE
+    success &= list->register_cmd(list, list->create(
+        builtin_handler_list_delete,
+        scallop,
+        "delete",
+        " <list-name>",
+        "remove a list"));
+
+    // BASE LANGUAGE
+    scallop_cmd_t * map = cmds->create(
+        builtin_handler_map,
+        scallop,
+        "map",
+        " <map-command> <...>",
+        "create and modify map variables, referenced as {name.key}");
+
+    success &= cmds->register_cmd(cmds, map);
+
+    // BASE LANGUAGE
+    success &= map->register_cmd(map, map->create(
+        builtin_handler_map_set,
+        scallop,
+        "set",
+        " <map-name> <key> <value>",
+        "set the value of a key, creating the map if needed"));
+
+    // BASE LANGUAGE
+    success &= map->register_cmd(map, map->create(
+        builtin_handler_map_get,
+        scallop,
+        "get",
+        " <map-name> <key> <var-name>",
+        "assign the value of a key to a variable"));
+
+    // BASE LANGUAGE
+    success &= map->register_cmd(map, map->create(
+        builtin_handler_map_del,
+        scallop,
+        "del",
+        " <map-name> [key]",
+        "remove a key, or the whole map"));
+
+    // BASE LANGUAGE
+    success &= map->register_cmd(map, map->create(
+        builtin_handler_map_keys,
+        scallop,
+        "keys",
+        " <map-name> <list-name>",
+        "put the sorted keys of a map in a list"));
+
+    // BASE LANGUAGE
+    success &= map->register_cmd(map, map->create(
+        builtin_handler_map_size,
+        scallop,
+        "size",
+        " <map-name>",
+        "result is the number of keys"));
+
+    // BASE LANGUAGE
+    scallop_cmd_t * profile = cmds->create(
+        builtin_handler_profile,
+        scallop,
+        "profile",
+        " <profile-command> <...>",
+        "measure calls, errors and time spent in each command");
+
+    success &= cmds->register_cmd(cmds, profile);
+
+    // BASE LANGUAGE
+    success &= profile->register_cmd(profile, profile->create(
+        builtin_handler_profile_on,
+        scallop,
+        "on",
+        NULL,
+        "start collecting command and line statistics"));
+
+    // BASE LANGUAGE
+    success &= profile->register_cmd(profile, profile->create(
+        builtin_handler_profile_off,
+        scallop,
+        "off",
+        NULL,
+        "stop collecting command and line statistics"));
+
+    // BASE LANGUAGE
+    success &= profile->register_cmd(profile, profile->create(
+        builtin_handler_profile_show,
+        scallop,
+        "show",
+        NULL,
+        "report statistics, most total time first"));
+
+    // BASE LANGUAGE
+    success &= profile->register_cmd(profile, profile->create(
+        builtin_handler_profile_listing,
+        scallop,
+        "listing",
+        " [routine-name]",
+        "show routine lines with hit counts and time share"));
+
+    // BASE LANGUAGE
+    success &= profile->register_cmd(profile, profile->create(
+        builtin_handler_profile_reset,
+        scallop,
+        "reset",
+        NULL,
+        "clear all command and line statistics"));
+
+    // BASE LANGUAGE
+    scallop_cmd_t * trace = cmds->create(
+        builtin_handler_trace,
+        scallop,
+        "trace",
+        " <trace-command> <...>",
+        "record a timeline of dispatches for chrome://tracing");
+
+    success &= cmds->register_cmd(cmds, trace);
+
+    // BASE LANGUAGE
+    success &= trace->register_cmd(trace, trace->create(
+        builtin_handler_trace_start,
+        scallop,
+        "start",
+        " [events]",
+        "start recording, discarding any previous trace"));
+
+    // BASE LANGUAGE
+    success &= trace->register_cmd(trace, trace->create(
+        builtin_handler_trace_stop,
+        scallop,
+        "stop",
+        NULL,
+        "stop recording"));
+
+    // BASE LANGUAGE
+    success &= trace->register_cmd(trace, trace->create(
+        builtin_handler_trace_dump,
+        scallop,
+        "dump",
+        " <file-name>",
+        "write the recorded trace as trace-event JSON"));
+
+    // CORE
+    success &= cmds->register_cmd(cmds, cmds->create(
+        builtin_handler_flush,
+        scallop,
+        "flush",
+        NULL,
+        "write out any buffered console output now"));
+
+    // CORE
+    scallop_cmd_t * snapshot = cmds->create(
+        builtin_handler_snapshot,
+        scallop,
+        "snapshot",
+        " <snapshot-command> <...>",
+        "save or restore variables, routines and aliases");
+
+    success &= cmds->register_cmd(cmds, snapshot);
+
+    // CORE
+    success &= snapshot->register_cmd(snapshot, snapshot->create(
+        builtin_handler_snapshot_save,
+        scallop,
+        "save",
+        " <file-name>",
+        "save variables, routines and aliases to a file"));
+
+    // CORE
+    success &= snapshot->register_cmd(snapshot, snapshot->create(
+        builtin_handler_snapshot_load,
+        scallop,
+        "load",
+        " <file-name>",
+        "restore variables, routines and aliases from a file"));
+
     // BASE LANGUAGE
     cmd = cmds->create(
         builtin_handler_while,
@@ -1090,6 +3175,26 @@ bool register_builtin_commands(void * scallop_ptr)
     cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_PUSH);
     success &= cmds->register_cmd(cmds, cmd);
 
+    // BASE LANGUAGE
+    cmd = cmds->create(
+        builtin_handler_for,
+        scallop,
+        "for",
+        " <var-name> <start> <end> [step]",
+        "declare a counting loop from start up to (not including) end");
+    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_PUSH);
+    success &= cmds->register_cmd(cmds, cmd);
+
+    // BASE LANGUAGE
+    cmd = cmds->create(
+        builtin_handler_foreach,
+        scallop,
+        "foreach",
+        " <var-name> <list-name>",
+        "declare a loop over each item of a list");
+    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_PUSH);
+    success &= cmds->register_cmd(cmds, cmd);
+
     // BASE LANGUAGE
     cmd = cmds->create(
         builtin_handler_if,
@@ -1106,10 +3211,54 @@ bool register_builtin_commands(void * scallop_ptr)
         scallop,
         "else",
         "",
-        "denotes the \'else\' part of an if-else construct");
+        "denotes the \'else\' part of an if-else or switch construct");
+    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_MODIFIER);
+    success &= cmds->register_cmd(cmds, cmd);
+
+    // BASE LANGUAGE
+    cmd = cmds->create(
+        builtin_handler_switch,
+        scallop,
+        "switch",
+        " (expression)",
+        "declare a switch construct selecting a case by value");
+    cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_PUSH);
+    success &= cmds->register_cmd(cmds, cmd);
+
+    // BASE LANGUAGE
+    cmd = cmds->create(
+        builtin_handler_case,
+        scallop,
+        "case",
+        " <value> [value ...]",
+        "denotes a \'case\' arm of a switch construct");
     cmd->set_attributes(cmd, SCALLOP_CMD_ATTR_CONSTRUCT_MODIFIER);
     success &= cmds->register_cmd(cmds, cmd);
 
+    // BASE LANGUAGE
+    success &= cmds->register_cmd(cmds, cmds->create(
+        builtin_handler_break,
+        scallop,
+        "break",
+        NULL,
+        "exit the innermost loop immediately"));
+
+    // BASE LANGUAGE
+    success &= cmds->register_cmd(cmds, cmds->create(
+        builtin_handler_continue,
+        scallop,
+        "continue",
+        NULL,
+        "skip to the next iteration of the innermost loop"));
+
+    // BASE LANGUAGE
+    success &= cmds->register_cmd(cmds, cmds->create(
+        builtin_handler_return,
+        scallop,
+        "return",
+        " [value]",
+        "exit the current routine, setting its result"));
+
     // BASE LANGUAGE
     cmd = cmds->create(
         builtin_handler_end,
@@ -28,3 +28,7 @@
 //------------------------------------------------------------------------|
 // Registration function for all the default commands and constructs
 bool register_builtin_commands(void * scallop);
+
+// Register a fully defined routine (a scallop_rtn_t *) as a command by
+// its name, as 'end' does for a routine declaration
+bool register_routine_command(void * scallop, void * routine);
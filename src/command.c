@@ -32,6 +32,9 @@
 #include "chain.h"
 #include "bytes.h"
 
+#include "clock.h"
+#include "logging.h"
+
 //------------------------------------------------------------------------|
 // Container for a command - private data
 typedef struct
@@ -69,9 +72,23 @@ typedef struct
 
     // description of what the command does
     bytes_t * description;
+
+    // keyword of the command this is an alias of, or NULL
+    bytes_t * original;
+
+    // Execution statistics, only updated while profiling
+    scallop_cmd_stats_t stats;
 }
 scallop_cmd_priv_t;
 
+//------------------------------------------------------------------------|
+// Profiling applies to every command at once, so that commands created
+// after it is turned on are included too.
+static bool scallop_cmd_profiling = false;
+
+// Counts every registration and unregistration, of any command anywhere
+static size_t scallop_cmd_registry_changes = 0;
+
 //------------------------------------------------------------------------|
 static scallop_cmd_t * scallop_cmd_create(scallop_cmd_handler_f handler,
                                           void * context,
@@ -112,6 +129,10 @@ static void scallop_cmd_destroy(void * cmd_ptr)
     priv->description->destroy(priv->description);
     priv->arghints->destroy(priv->arghints);
     priv->keyword->destroy(priv->keyword);
+    if (priv->original)
+    {
+        priv->original->destroy(priv->original);
+    }
 
     // Recursively destroy command tree, if there are any nodes,
     // and IF the pointer to those nodes is not an alias copy
@@ -141,6 +162,9 @@ static void * scallop_cmd_copy(const void * cmd_ptr)
     scallop_cmd_priv_t * copy_priv = (scallop_cmd_priv_t *) copy->priv;
 
     copy_priv->attributes = priv->attributes;
+    copy_priv->original = priv->original ?
+                            (bytes_t *) bytes_pub.copy(priv->original) :
+                            NULL;
 
     // Command may or may not have sub-commands
     copy_priv->cmds = priv->cmds ?
@@ -189,6 +213,7 @@ static scallop_cmd_t * scallop_cmd_alias(scallop_cmd_t * cmd,
     // could lead to some weird unexpected behavior.
     scallop_cmd_priv_t * alias_priv = (scallop_cmd_priv_t *) alias->priv;
     alias_priv->cmds = priv->cmds;
+    alias_priv->original = (bytes_t *) bytes_pub.copy(priv->keyword);
 
     // Don't need this temporary buffer anymore
     description->destroy(description);
@@ -220,7 +245,7 @@ static scallop_cmd_t * scallop_cmd_find_by_keyword(scallop_cmd_t * cmd,
 
     if (!priv->cmds)
     {
-        BLAMMO(VERBOSE, "Empty command registry");
+        SCALLOP_LOG(VERBOSE, "Empty command registry");
         return NULL;
     }
 
@@ -260,8 +285,8 @@ static chain_t * scallop_cmd_partial_matches(scallop_cmd_t * cmd,
     // sub-command tree, in which case priv->cmds is NULL.
     if (!substring || !priv->cmds)
     {
-        BLAMMO(DEBUG, "substring: %p  sub-commands: %p",
-                      substring, priv->cmds);
+        SCALLOP_LOG(DEBUG, "substring: %p  sub-commands: %p",
+                           substring, priv->cmds);
         return NULL;
     }
 
@@ -275,7 +300,7 @@ static chain_t * scallop_cmd_partial_matches(scallop_cmd_t * cmd,
 
     while (subcmd)
     {
-        BLAMMO(DEBUG, "checking \'%s\' against \'%s\'",
+        SCALLOP_LOG(DEBUG, "checking \'%s\' against \'%s\'",
                 subcmd->keyword(subcmd), substring);
         if (!strncmp(subcmd->keyword(subcmd), substring, sublength))
         {
@@ -294,6 +319,33 @@ static chain_t * scallop_cmd_partial_matches(scallop_cmd_t * cmd,
     return pmatches;
 }
 
+//------------------------------------------------------------------------|
+// Kept out of line so the common unprofiled path stays small
+static int scallop_cmd_exec_profiled(scallop_cmd_t * cmd,
+                                     int argc,
+                                     char ** args)
+{
+    OBJECT_PRIV(scallop_, cmd);
+    uint64_t start = scallop_clock_ns();
+    uint64_t elapsed = 0;
+    int result = priv->handler(cmd, priv->context, argc, args);
+
+    elapsed = scallop_clock_ns() - start;
+    priv->stats.calls++;
+    priv->stats.total_ns += elapsed;
+    if (elapsed > priv->stats.max_ns)
+    {
+        priv->stats.max_ns = elapsed;
+    }
+
+    if (result == ERROR_MARKER_DEC)
+    {
+        priv->stats.errors++;
+    }
+
+    return result;
+}
+
 //------------------------------------------------------------------------|
 static inline int scallop_cmd_exec(scallop_cmd_t * cmd,
                                    int argc,
@@ -301,9 +353,17 @@ static inline int scallop_cmd_exec(scallop_cmd_t * cmd,
 {
     OBJECT_PRIV(scallop_, cmd);
 
-    return priv->handler ?
-           priv->handler(cmd, priv->context, argc, args) :
-           0;
+    if (!priv->handler)
+    {
+        return 0;
+    }
+
+    if (scallop_cmd_profiling)
+    {
+        return scallop_cmd_exec_profiled(cmd, argc, args);
+    }
+
+    return priv->handler(cmd, priv->context, argc, args);
 }
 
 //------------------------------------------------------------------------|
@@ -329,6 +389,13 @@ static inline bool scallop_cmd_is_alias(scallop_cmd_t * cmd)
     return priv->attributes & SCALLOP_CMD_ATTR_ALIAS;
 }
 
+//------------------------------------------------------------------------|
+static inline const char * scallop_cmd_original(scallop_cmd_t * cmd)
+{
+    OBJECT_PRIV(scallop_, cmd);
+    return priv->original ? priv->original->cstr(priv->original) : NULL;
+}
+
 //------------------------------------------------------------------------|
 static inline bool scallop_cmd_is_mutable(scallop_cmd_t * cmd)
 {
@@ -479,7 +546,7 @@ static int scallop_cmd_help(scallop_cmd_t * cmd,
     //  would probably need to put parent links in all commands
     if (!keyword->empty(keyword))
     {
-        BLAMMO(VERBOSE, "indentation for command: %s", keyword->cstr(keyword));
+        SCALLOP_LOG(VERBOSE, "indentation for command: %s", keyword->cstr(keyword));
         indent->append(indent, keyword->data(keyword),
                                keyword->size(keyword));
         indent->append(indent, " ", 1);
@@ -490,7 +557,7 @@ static int scallop_cmd_help(scallop_cmd_t * cmd,
     scallop_cmd_t * subcmd = priv->cmds->first(priv->cmds);
     while (subcmd)
     {
-        BLAMMO(VERBOSE, "getting help for sub-command: %s", subcmd->keyword(subcmd));
+        SCALLOP_LOG(VERBOSE, "getting help for sub-command: %s", subcmd->keyword(subcmd));
         subpriv = (scallop_cmd_priv_t *) subcmd->priv;
 
         // align the description column by the longest keyword+args
@@ -508,7 +575,7 @@ static int scallop_cmd_help(scallop_cmd_t * cmd,
                        subcmd->arghints(subcmd),
                        pad->cstr(pad),
                        subcmd->description(subcmd));
-        BLAMMO(VERBOSE, "subhelp->cstr: %s", subhelp->cstr(subhelp));
+        SCALLOP_LOG(VERBOSE, "subhelp->cstr: %s", subhelp->cstr(subhelp));
 
         subcmd->help(subcmd, subhelp, ++depth, longest_kw_and_hints);
         depth--;
@@ -527,6 +594,115 @@ static int scallop_cmd_help(scallop_cmd_t * cmd,
     return 0;
 }
 
+//------------------------------------------------------------------------|
+static void scallop_cmd_set_profiling(bool enable)
+{
+    scallop_cmd_profiling = enable;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_cmd_is_profiling()
+{
+    return scallop_cmd_profiling;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_cmd_changes()
+{
+    return scallop_cmd_registry_changes;
+}
+
+//------------------------------------------------------------------------|
+static const scallop_cmd_stats_t * scallop_cmd_stats(scallop_cmd_t * cmd)
+{
+    OBJECT_PRIV(scallop_, cmd);
+    return &priv->stats;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_cmd_reset_stats(scallop_cmd_t * cmd)
+{
+    OBJECT_PRIV(scallop_, cmd);
+
+    memzero(&priv->stats, sizeof(priv->stats));
+
+    // Done when we hit a terminal command node
+    if (!priv->cmds || !priv->cmds->priv)
+    {
+        return;
+    }
+
+    scallop_cmd_t * subcmd = priv->cmds->first(priv->cmds);
+    while (subcmd)
+    {
+        subcmd->reset_stats(subcmd);
+        subcmd = (scallop_cmd_t *) priv->cmds->next(priv->cmds);
+    }
+}
+
+//------------------------------------------------------------------------|
+static void scallop_cmd_each_stats(scallop_cmd_t * cmd,
+                                   const char * prefix,
+                                   scallop_cmd_stats_f visit,
+                                   void * object)
+{
+    OBJECT_PRIV(scallop_, cmd);
+    bytes_t * path = NULL;
+
+    // Done when we hit a terminal command node
+    if (!priv->cmds || !priv->cmds->priv)
+    {
+        return;
+    }
+
+    path = bytes_pub.create(NULL, 0);
+
+    scallop_cmd_priv_t * subpriv = NULL;
+    scallop_cmd_t * subcmd = priv->cmds->first(priv->cmds);
+    while (subcmd)
+    {
+        subpriv = (scallop_cmd_priv_t *) subcmd->priv;
+        if (prefix)
+        {
+            path->print(path, "%s %s", prefix, subcmd->keyword(subcmd));
+        }
+        else
+        {
+            path->print(path, "%s", subcmd->keyword(subcmd));
+        }
+
+        if (subpriv->stats.calls > 0)
+        {
+            visit(object, path->cstr(path), &subpriv->stats);
+        }
+
+        subcmd->each_stats(subcmd, path->cstr(path), visit, object);
+        subcmd = (scallop_cmd_t *) priv->cmds->next(priv->cmds);
+    }
+
+    path->destroy(path);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_cmd_each(scallop_cmd_t * cmd,
+                             scallop_cmd_visit_f visit,
+                             void * object)
+{
+    OBJECT_PRIV(scallop_, cmd);
+
+    if (!priv->cmds || !priv->cmds->priv)
+    {
+        return;
+    }
+
+    scallop_cmd_t * subcmd = priv->cmds->first(priv->cmds);
+    while (subcmd)
+    {
+        visit(object, subcmd);
+        subcmd = (scallop_cmd_t *) priv->cmds->next(priv->cmds);
+    }
+}
+
 //------------------------------------------------------------------------|
 bool scallop_cmd_register_cmd(scallop_cmd_t * parent,
                               scallop_cmd_t * child)
@@ -569,6 +745,7 @@ bool scallop_cmd_register_cmd(scallop_cmd_t * parent,
     // they were registered
     priv->cmds->last(priv->cmds);
     priv->cmds->insert(priv->cmds, child);
+    scallop_cmd_registry_changes++;
     return true;
 }
 
@@ -580,7 +757,7 @@ bool scallop_cmd_unregister_cmd(scallop_cmd_t * parent,
 
     if (!priv->cmds)
     {
-        BLAMMO(VERBOSE, "Empty command registry");
+        SCALLOP_LOG(VERBOSE, "Empty command registry");
         return false;
     }
 
@@ -610,6 +787,7 @@ bool scallop_cmd_unregister_cmd(scallop_cmd_t * parent,
 
     // Remove the found command link -- this also destroys the found command
     priv->cmds->remove(priv->cmds);
+    scallop_cmd_registry_changes++;
 
 #if 0
     // EXPERIMENTAL.  It's unclear what should happen if the alias
@@ -658,6 +836,7 @@ const scallop_cmd_t scallop_cmd_pub = {
     &scallop_cmd_set_attributes,
     &scallop_cmd_clear_attributes,
     &scallop_cmd_is_alias,
+    &scallop_cmd_original,
     &scallop_cmd_is_mutable,
     &scallop_cmd_is_construct,
     &scallop_cmd_is_construct_pop,
@@ -668,7 +847,14 @@ const scallop_cmd_t scallop_cmd_pub = {
     &scallop_cmd_description,
     &scallop_cmd_longest,
     &scallop_cmd_help,
+    &scallop_cmd_set_profiling,
+    &scallop_cmd_is_profiling,
+    &scallop_cmd_stats,
+    &scallop_cmd_reset_stats,
+    &scallop_cmd_each_stats,
+    &scallop_cmd_each,
     &scallop_cmd_register_cmd,
     &scallop_cmd_unregister_cmd,
+    &scallop_cmd_changes,
     NULL
 };
@@ -75,6 +75,27 @@ typedef enum
 }
 scallop_cmd_attr_t;
 
+//------------------------------------------------------------------------|
+// Execution statistics kept for each command while profiling is on.
+// Times are wall clock and include any nested dispatches.
+typedef struct
+{
+    size_t calls;
+    size_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+}
+scallop_cmd_stats_t;
+
+// Visitor for commands that have statistics, given the full keyword path
+// to the command, such as "memo stats"
+typedef void (*scallop_cmd_stats_f)(void * object,
+                                    const char * path,
+                                    const scallop_cmd_stats_t * stats);
+
+// Visitor for each of a command's sub-commands (scallop_cmd_t *)
+typedef void (*scallop_cmd_visit_f)(void * object, void * cmd);
+
 //------------------------------------------------------------------------|
 // Command handler function signature.
 typedef int (*scallop_cmd_handler_f) (void * cmd,
@@ -134,6 +155,10 @@ typedef struct scallop_cmd_t
     // Get whether this command is an alias to another command
     bool (*is_alias)(struct scallop_cmd_t * cmd);
 
+    // Get the keyword of the command an alias was made from, or NULL
+    // if this is not an alias
+    const char * (*original)(struct scallop_cmd_t * cmd);
+
     // Get whether this command was registered at runtime, and can
     // be unregistered or redefined.
     bool (*is_mutable)(struct scallop_cmd_t * cmd);
@@ -172,6 +197,32 @@ typedef struct scallop_cmd_t
                 size_t depth,
                 size_t longest_kw_and_hints);
 
+    // Turn execution profiling on or off for all commands.  While off,
+    // exec() costs only a single extra branch.
+    void (*set_profiling)(bool enable);
+
+    // Whether execution profiling is on
+    bool (*is_profiling)();
+
+    // Get execution statistics for _this_ command
+    const scallop_cmd_stats_t * (*stats)(struct scallop_cmd_t * cmd);
+
+    // Recursively clear statistics for _this_ and all sub-commands
+    void (*reset_stats)(struct scallop_cmd_t * cmd);
+
+    // Recursively visit all sub-commands that have been run since the
+    // last reset.  prefix is the keyword path leading to cmd, or NULL.
+    void (*each_stats)(struct scallop_cmd_t * cmd,
+                       const char * prefix,
+                       scallop_cmd_stats_f visit,
+                       void * object);
+
+    // Visit each immediate sub-command, not recursively.  The visitor
+    // must not register or unregister commands here.
+    void (*each)(struct scallop_cmd_t * cmd,
+                 scallop_cmd_visit_f visit,
+                 void * object);
+
     // Register a sub-command within the context of this command.
     // If this is serving as the root-level command, then this
     // represents a base level command
@@ -182,6 +233,11 @@ typedef struct scallop_cmd_t
     bool (*unregister_cmd)(struct scallop_cmd_t * parent,
                            struct scallop_cmd_t * child);
 
+    // Get the number of times any command has been registered or
+    // unregistered.  While this is unchanged, commands looked up earlier
+    // are still the ones that would be found now.
+    size_t (*changes)();
+
     // Private data
     void * priv;
 }
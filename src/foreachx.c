@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+#include "console.h"
+#include "bytes.h"
+
+// Scallop
+#include "scallop.h"
+#include "command.h"
+#include "lines.h"
+#include "list.h"
+#include "foreachx.h"
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Name of the loop variable
+    bytes_t * varname;
+
+    // Raw unevaluated name of the list variable iterated over, and the
+    // name it resolved to when the loop started
+    bytes_t * listname;
+    bytes_t * resolved;
+
+    // The native index of the current item, bound into scallop
+    long index;
+
+    // Raw command lines consisting of the foreach body
+    scallop_lines_t * lines;
+}
+scallop_foreachx_priv_t;
+
+//------------------------------------------------------------------------|
+static scallop_foreachx_t * scallop_foreachx_create(const char * varname,
+                                                    const char * listname)
+{
+    OBJECT_ALLOC(scallop_, foreachx);
+
+    priv->varname = bytes_pub.create(varname, strlen(varname));
+    priv->listname = bytes_pub.create(listname, strlen(listname));
+    priv->resolved = bytes_pub.create(NULL, 0);
+    if (!priv->varname || !priv->listname || !priv->resolved)
+    {
+        BLAMMO(FATAL, "bytes_pub.create() failed");
+        foreachx->destroy(foreachx);
+        return NULL;
+    }
+
+    priv->lines = scallop_lines_pub.create();
+    if (!priv->lines)
+    {
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
+        foreachx->destroy(foreachx);
+        return NULL;
+    }
+
+    return foreachx;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_foreachx_destroy(void * foreachx_ptr)
+{
+    OBJECT_PTR(scallop_, foreachx, foreachx_ptr, );
+
+    if (priv->lines)
+    {
+        priv->lines->destroy(priv->lines);
+    }
+
+    if (priv->resolved)
+    {
+        priv->resolved->destroy(priv->resolved);
+    }
+
+    if (priv->listname)
+    {
+        priv->listname->destroy(priv->listname);
+    }
+
+    if (priv->varname)
+    {
+        priv->varname->destroy(priv->varname);
+    }
+
+    OBJECT_FREE(scallop_, foreachx);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_foreachx_append(scallop_foreachx_t * foreachx,
+                                    const char * line)
+{
+    OBJECT_PRIV(scallop_, foreachx);
+    priv->lines->append(priv->lines, line);
+}
+
+//------------------------------------------------------------------------|
+static int scallop_foreachx_runner(scallop_foreachx_t * foreachx,
+                                   void * context)
+{
+    OBJECT_PRIV(scallop_, foreachx);
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    const char * varname = priv->varname->cstr(priv->varname);
+    const char * listname = NULL;
+    scallop_unwind_t unwind = SCALLOP_UNWIND_NONE;
+    scallop_list_t * list = NULL;
+    const char * last = NULL;
+    int result = 0;
+
+    // The list may be named indirectly, as with a routine argument
+    priv->resolved->assign(priv->resolved,
+                           priv->listname->data(priv->listname),
+                           priv->listname->size(priv->listname));
+    if (!scallop->substitute(scallop, priv->resolved))
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    listname = priv->resolved->cstr(priv->resolved);
+    if (!scallop->list_by_name(scallop, listname))
+    {
+        console->error(console, "list \'%s\' not found", listname);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (!scallop->bind_item(scallop, varname, listname, &priv->index))
+    {
+        console->error(console, "too many nested loops over \'%s\'", varname);
+        return ERROR_MARKER_DEC;
+    }
+
+    // The list is looked up again on every pass, since the body may
+    // have grown, shrunk, replaced or removed it.
+    for (priv->index = 0;
+         (list = scallop->list_by_name(scallop, listname)) &&
+         (size_t) priv->index < list->length(list);
+         priv->index++)
+    {
+        // Iterate through all lines and dispatch each
+        result = scallop->run_lines(scallop, priv->lines);
+
+        // Consume 'break' and 'continue' meant for this loop, but
+        // leave 'return' pending for the enclosing routine.
+        unwind = scallop->unwinding(scallop);
+        if (unwind == SCALLOP_UNWIND_RETURN)
+        {
+            break;
+        }
+        else if (unwind != SCALLOP_UNWIND_NONE)
+        {
+            scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+            if (unwind == SCALLOP_UNWIND_BREAK)
+            {
+                break;
+            }
+        }
+    }
+
+    scallop->unbind(scallop);
+
+    // Leave the last item visited behind as an ordinary variable, like
+    // the final counter of a for loop.
+    list = scallop->list_by_name(scallop, listname);
+    last = list ? list->get(list, priv->index) : NULL;
+    if (!last && list && priv->index > 0)
+    {
+        last = list->get(list, priv->index - 1);
+    }
+
+    if (last)
+    {
+        scallop->assign_variable(scallop, varname, last);
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+const scallop_foreachx_t scallop_foreachx_pub = {
+    &scallop_foreachx_create,
+    &scallop_foreachx_destroy,
+    &scallop_foreachx_append,
+    &scallop_foreachx_runner,
+    NULL
+};
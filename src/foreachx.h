@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop foreach loop runs its body once per item of a list variable,
+// in order.  The loop variable is bound to the list and a native index,
+// so '{var}' reads the current item directly without building any names
+// or copying items.  Items pushed by the body are visited as well.
+
+typedef struct scallop_foreachx_t
+{
+    // Foreach loop factory function
+    struct scallop_foreachx_t * (*create)(const char * varname,
+                                          const char * listname);
+
+    // Foreach loop destructor function
+    void (*destroy)(void * foreachx);
+
+    // Append a line to the foreach loop
+    void (*append)(struct scallop_foreachx_t * foreachx, const char * line);
+
+    // Run the foreach loop
+    int (*runner)(struct scallop_foreachx_t * foreachx, void * context);
+
+    // Private data
+    void * priv;
+}
+scallop_foreachx_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_foreachx_t scallop_foreachx_pub;
@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+#include "console.h"
+#include "bytes.h"
+
+// Scallop
+#include "scallop.h"
+#include "command.h"
+#include "lines.h"
+#include "forx.h"
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Name of the loop counter variable
+    bytes_t * varname;
+
+    // Raw unevaluated range expressions.  These are only evaluated
+    // once, when the loop begins to run.
+    bytes_t * start;
+    bytes_t * end;
+    bytes_t * step;
+
+    // The native loop counter, bound into scallop while running
+    long counter;
+
+    // Raw command lines consisting of the for body
+    scallop_lines_t * lines;
+}
+scallop_forx_priv_t;
+
+//------------------------------------------------------------------------|
+static scallop_forx_t * scallop_forx_create(const char * varname,
+                                            const char * start,
+                                            const char * end,
+                                            const char * step)
+{
+    OBJECT_ALLOC(scallop_, forx);
+
+    // Default to counting up by one
+    if (!step)
+    {
+        step = "1";
+    }
+
+    priv->varname = bytes_pub.create(varname, strlen(varname));
+    priv->start = bytes_pub.create(start, strlen(start));
+    priv->end = bytes_pub.create(end, strlen(end));
+    priv->step = bytes_pub.create(step, strlen(step));
+    if (!priv->varname || !priv->start || !priv->end || !priv->step)
+    {
+        BLAMMO(FATAL, "bytes_pub.create() failed");
+        forx->destroy(forx);
+        return NULL;
+    }
+
+    priv->lines = scallop_lines_pub.create();
+    if (!priv->lines)
+    {
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
+        forx->destroy(forx);
+        return NULL;
+    }
+
+    return forx;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_forx_destroy(void * forx_ptr)
+{
+    OBJECT_PTR(scallop_, forx, forx_ptr, );
+
+    if (priv->lines)
+    {
+        priv->lines->destroy(priv->lines);
+    }
+
+    if (priv->step)
+    {
+        priv->step->destroy(priv->step);
+    }
+
+    if (priv->end)
+    {
+        priv->end->destroy(priv->end);
+    }
+
+    if (priv->start)
+    {
+        priv->start->destroy(priv->start);
+    }
+
+    if (priv->varname)
+    {
+        priv->varname->destroy(priv->varname);
+    }
+
+    OBJECT_FREE(scallop_, forx);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_forx_append(scallop_forx_t * forx, const char * line)
+{
+    OBJECT_PRIV(scallop_, forx);
+    priv->lines->append(priv->lines, line);
+}
+
+//------------------------------------------------------------------------|
+static int scallop_forx_runner(scallop_forx_t * forx,
+                               void * context)
+{
+    OBJECT_PRIV(scallop_, forx);
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    const char * varname = priv->varname->cstr(priv->varname);
+    scallop_unwind_t unwind = SCALLOP_UNWIND_NONE;
+    long start = 0;
+    long end = 0;
+    long step = 0;
+    int result = 0;
+
+    // Evaluate the range exactly once, up front
+    if (!scallop->evaluate_value(scallop,
+                                 priv->start->cstr(priv->start),
+                                 priv->start->size(priv->start),
+                                 &start) ||
+        !scallop->evaluate_value(scallop,
+                                 priv->end->cstr(priv->end),
+                                 priv->end->size(priv->end),
+                                 &end) ||
+        !scallop->evaluate_value(scallop,
+                                 priv->step->cstr(priv->step),
+                                 priv->step->size(priv->step),
+                                 &step))
+    {
+        console->error(console, "invalid range for loop over \'%s\'", varname);
+        return ERROR_MARKER_DEC;
+    }
+
+    if (step == 0)
+    {
+        console->error(console, "for loop over \'%s\' has zero step", varname);
+        return ERROR_MARKER_DEC;
+    }
+
+    // References to the loop variable now resolve to the counter itself
+    if (!scallop->bind_counter(scallop, varname, &priv->counter))
+    {
+        console->error(console, "too many nested loops over \'%s\'", varname);
+        return ERROR_MARKER_DEC;
+    }
+
+    priv->counter = start;
+    while (step > 0 ? priv->counter < end : priv->counter > end)
+    {
+        // Iterate through all lines and dispatch each
+        result = scallop->run_lines(scallop, priv->lines);
+
+        // Consume 'break' and 'continue' meant for this loop, but
+        // leave 'return' pending for the enclosing routine.
+        unwind = scallop->unwinding(scallop);
+        if (unwind == SCALLOP_UNWIND_RETURN)
+        {
+            break;
+        }
+        else if (unwind != SCALLOP_UNWIND_NONE)
+        {
+            scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+            if (unwind == SCALLOP_UNWIND_BREAK)
+            {
+                break;
+            }
+        }
+
+        // Stop at the end rather than step past the range of a long
+        if (step > 0 ? priv->counter > LONG_MAX - step :
+                       priv->counter < LONG_MIN - step)
+        {
+            priv->counter = end;
+            break;
+        }
+
+        priv->counter += step;
+    }
+
+    scallop->unbind(scallop);
+
+    // Leave the final value behind as an ordinary variable, so that
+    // lines following the loop see what they would have with 'while'.
+    bytes_t * value = bytes_pub.print_create("%ld", priv->counter);
+    scallop->assign_variable(scallop, varname, value->cstr(value));
+    value->destroy(value);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+const scallop_forx_t scallop_forx_pub = {
+    &scallop_forx_create,
+    &scallop_forx_destroy,
+    &scallop_forx_append,
+    &scallop_forx_runner,
+    NULL
+};
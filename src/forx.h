@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop for loop is a counting loop over a numeric range, like a
+// while loop with the condition and increment built in.  The bounds are
+// evaluated once when the loop starts, and the counter is kept as a
+// native integer that is only formatted as text when a line actually
+// references it.  The range excludes the end value, as with C's
+// 'for (i = start; i < end; i += step)'.  A negative step counts down.
+
+typedef struct scallop_forx_t
+{
+    // For loop factory function.  All arguments are raw unevaluated
+    // text.  step may be NULL for the default of 1.
+    struct scallop_forx_t * (*create)(const char * varname,
+                                      const char * start,
+                                      const char * end,
+                                      const char * step);
+
+    // For loop destructor function
+    void (*destroy)(void * forx);
+
+    // Append a line to the for loop
+    void (*append)(struct scallop_forx_t * forx, const char * line);
+
+    // Run the for loop
+    int (*runner)(struct scallop_forx_t * forx, void * context);
+
+    // Private data
+    void * priv;
+}
+scallop_forx_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_forx_t scallop_forx_pub;
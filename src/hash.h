@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+//------------------------------------------------------------------------|
+// FNV-1a is more than good enough for the short strings scallop hashes:
+// variable and map keys, memoized arguments and command keywords.
+static inline size_t scallop_hash_bytes(const char * data, size_t size)
+{
+    size_t hash = (size_t) 2166136261u;
+    size_t index = 0;
+
+    for (index = 0; index < size; index++)
+    {
+        hash ^= (unsigned char) data[index];
+        hash *= (size_t) 16777619u;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_hash_string(const char * text)
+{
+    return scallop_hash_bytes(text, strlen(text));
+}
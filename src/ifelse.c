@@ -31,12 +31,12 @@
 #include "utils.h"              // memzero(), OBJECT macros
 #include "blammo.h"
 #include "console.h"
-#include "chain.h"
 #include "bytes.h"
 
 // Scallop
 #include "scallop.h"
 #include "command.h"
+#include "lines.h"
 #include "ifelse.h"
 
 //------------------------------------------------------------------------|
@@ -46,11 +46,11 @@ typedef struct
     bytes_t * condition;
 
     // Raw command lines consisting of the if-else blocks
-    chain_t * if_lines;
-    chain_t * else_lines;
+    scallop_lines_t * if_lines;
+    scallop_lines_t * else_lines;
 
     // which list of lines is being added to
-    chain_t * lines;
+    scallop_lines_t * lines;
 }
 scallop_ifelse_priv_t;
 
@@ -72,20 +72,18 @@ static scallop_ifelse_t * scallop_ifelse_create(const char * condition)
     // List of raw (mostly) uninterpreted command lines consisting
     // of the body of the ifelse.  One exception to this is we'll
     // need to track the nested depth of an 'end' keyword (multi-use)
-    priv->if_lines = chain_pub.create(bytes_pub.copy,
-                                     bytes_pub.destroy);
+    priv->if_lines = scallop_lines_pub.create();
     if (!priv->if_lines)
     {
-        BLAMMO(FATAL, "chain_pub.create() failed");
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
         ifelse->destroy(ifelse);
         return NULL;
     }
 
-    priv->else_lines = chain_pub.create(bytes_pub.copy,
-                                       bytes_pub.destroy);
+    priv->else_lines = scallop_lines_pub.create();
     if (!priv->else_lines)
     {
-        BLAMMO(FATAL, "chain_pub.create() failed");
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
         ifelse->destroy(ifelse);
         return NULL;
     }
@@ -142,16 +140,7 @@ static void scallop_ifelse_append(scallop_ifelse_t * ifelse,
                                   const char * line)
 {
     OBJECT_PRIV(scallop_, ifelse);
-
-    // First create the line object
-    bytes_t * linebytes = bytes_pub.create(line, strlen(line));
-
-    // Make no assumptions about the state of the chain, but always
-    // force the insert at the 'end' of the chain, which is always at -1
-    // since the chain is circular.
-    priv->lines->reset(priv->lines);
-    priv->lines->spin(priv->lines, -1);
-    priv->lines->insert(priv->lines, linebytes);
+    priv->lines->append(priv->lines, line);
 }
 
 //------------------------------------------------------------------------|
@@ -0,0 +1,332 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "lines.h"
+
+//------------------------------------------------------------------------|
+// Initial capacities.  Both arrays double whenever they run out of room,
+// so these only need to be large enough to cover typical short bodies.
+#define SCALLOP_LINES_INITIAL_BUFFER    256
+#define SCALLOP_LINES_INITIAL_OFFSETS   16
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // All lines packed end-to-end, each with its own NUL terminator
+    char * buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+
+    // Offset within buffer to the beginning of each line
+    size_t * offsets;
+    size_t count;
+    size_t offsets_capacity;
+
+    // Per-line statistics, allocated lazily and grown to cover new lines
+    scallop_lines_stats_t * stats;
+    size_t stats_count;
+
+    // Statistics each line is also charged to, sized like offsets.
+    // Only allocated once a line is appended with an origin.
+    scallop_lines_stats_t ** origins;
+    bool ignore_origin;
+}
+scallop_lines_priv_t;
+
+//------------------------------------------------------------------------|
+// Origin for lines appended from now on, as set by whoever is running
+// profiled lines.  Shared by all containers, like command profiling.
+static scallop_lines_stats_t * scallop_lines_current_origin = NULL;
+
+//------------------------------------------------------------------------|
+static scallop_lines_t * scallop_lines_create()
+{
+    OBJECT_ALLOC(scallop_, lines);
+
+    priv->buffer = (char *) malloc(SCALLOP_LINES_INITIAL_BUFFER);
+    if (!priv->buffer)
+    {
+        BLAMMO(FATAL, "malloc(%u) failed", SCALLOP_LINES_INITIAL_BUFFER);
+        lines->destroy(lines);
+        return NULL;
+    }
+
+    priv->buffer_capacity = SCALLOP_LINES_INITIAL_BUFFER;
+
+    priv->offsets = (size_t *) malloc(SCALLOP_LINES_INITIAL_OFFSETS *
+                                      sizeof(size_t));
+    if (!priv->offsets)
+    {
+        BLAMMO(FATAL, "malloc(%u) offsets failed",
+                      SCALLOP_LINES_INITIAL_OFFSETS);
+        lines->destroy(lines);
+        return NULL;
+    }
+
+    priv->offsets_capacity = SCALLOP_LINES_INITIAL_OFFSETS;
+
+    return lines;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_lines_destroy(void * lines_ptr)
+{
+    OBJECT_PTR(scallop_, lines, lines_ptr, );
+
+    if (priv->origins)
+    {
+        free(priv->origins);
+    }
+
+    if (priv->stats)
+    {
+        free(priv->stats);
+    }
+
+    if (priv->offsets)
+    {
+        free(priv->offsets);
+    }
+
+    if (priv->buffer)
+    {
+        free(priv->buffer);
+    }
+
+    OBJECT_FREE(scallop_, lines);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_lines_append(scallop_lines_t * lines, const char * line)
+{
+    OBJECT_PRIV(scallop_, lines);
+    size_t length = strlen(line) + 1;
+    size_t capacity = priv->buffer_capacity;
+    void * grown = NULL;
+
+    // Grow the line buffer geometrically so that appends are amortized
+    while (priv->buffer_size + length > capacity)
+    {
+        capacity *= 2;
+    }
+
+    if (capacity != priv->buffer_capacity)
+    {
+        grown = realloc(priv->buffer, capacity);
+        if (!grown)
+        {
+            BLAMMO(FATAL, "realloc(%zu) failed", capacity);
+            return;
+        }
+
+        priv->buffer = (char *) grown;
+        priv->buffer_capacity = capacity;
+    }
+
+    // Likewise for the offset array
+    if (priv->count == priv->offsets_capacity)
+    {
+        grown = realloc(priv->offsets,
+                        priv->offsets_capacity * 2 * sizeof(size_t));
+        if (!grown)
+        {
+            BLAMMO(FATAL, "realloc(%zu) offsets failed",
+                          priv->offsets_capacity * 2);
+            return;
+        }
+
+        priv->offsets = (size_t *) grown;
+        priv->offsets_capacity *= 2;
+
+        if (priv->origins)
+        {
+            grown = realloc(priv->origins, priv->offsets_capacity *
+                            sizeof(scallop_lines_stats_t *));
+            if (!grown)
+            {
+                BLAMMO(FATAL, "realloc(%zu) origins failed",
+                              priv->offsets_capacity);
+                free(priv->origins);
+                priv->origins = NULL;
+            }
+            else
+            {
+                priv->origins = (scallop_lines_stats_t **) grown;
+            }
+        }
+    }
+
+    // Remember where this line came from, if anywhere
+    if (scallop_lines_current_origin && !priv->ignore_origin &&
+        !priv->origins)
+    {
+        priv->origins = (scallop_lines_stats_t **)
+                calloc(priv->offsets_capacity,
+                       sizeof(scallop_lines_stats_t *));
+    }
+
+    if (priv->origins)
+    {
+        priv->origins[priv->count] = priv->ignore_origin ?
+                                     NULL : scallop_lines_current_origin;
+    }
+
+    // Copy the line including its terminator and mark where it begins
+    memcpy(&priv->buffer[priv->buffer_size], line, length);
+    priv->offsets[priv->count++] = priv->buffer_size;
+    priv->buffer_size += length;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_lines_count(scallop_lines_t * lines)
+{
+    OBJECT_PRIV(scallop_, lines);
+    return priv->count;
+}
+
+//------------------------------------------------------------------------|
+static inline const char * scallop_lines_line(scallop_lines_t * lines,
+                                              size_t index)
+{
+    OBJECT_PRIV(scallop_, lines);
+    return index < priv->count ? &priv->buffer[priv->offsets[index]] : NULL;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_lines_length(scallop_lines_t * lines, size_t index)
+{
+    OBJECT_PRIV(scallop_, lines);
+
+    if (index >= priv->count)
+    {
+        return 0;
+    }
+
+    // The next line (or the end of the buffer) follows the terminator
+    size_t end = (index + 1 < priv->count) ?
+                 priv->offsets[index + 1] : priv->buffer_size;
+
+    return end - priv->offsets[index] - 1;
+}
+
+//------------------------------------------------------------------------|
+static scallop_lines_stats_t * scallop_lines_stats(scallop_lines_t * lines,
+                                                   size_t index)
+{
+    OBJECT_PRIV(scallop_, lines);
+    void * grown = NULL;
+
+    if (index >= priv->count)
+    {
+        return NULL;
+    }
+
+    // Cover every line appended since the statistics were last grown
+    if (index >= priv->stats_count)
+    {
+        grown = realloc(priv->stats,
+                        priv->count * sizeof(scallop_lines_stats_t));
+        if (!grown)
+        {
+            BLAMMO(FATAL, "realloc(%zu) stats failed", priv->count);
+            return NULL;
+        }
+
+        priv->stats = (scallop_lines_stats_t *) grown;
+        memzero(&priv->stats[priv->stats_count],
+                (priv->count - priv->stats_count) *
+                sizeof(scallop_lines_stats_t));
+        priv->stats_count = priv->count;
+    }
+
+    return &priv->stats[index];
+}
+
+//------------------------------------------------------------------------|
+static void scallop_lines_reset_stats(scallop_lines_t * lines)
+{
+    OBJECT_PRIV(scallop_, lines);
+
+    if (priv->stats)
+    {
+        memzero(priv->stats,
+                priv->stats_count * sizeof(scallop_lines_stats_t));
+    }
+}
+
+//------------------------------------------------------------------------|
+static scallop_lines_stats_t * scallop_lines_set_origin(
+                                        scallop_lines_stats_t * origin)
+{
+    scallop_lines_stats_t * previous = scallop_lines_current_origin;
+    scallop_lines_current_origin = origin;
+    return previous;
+}
+
+//------------------------------------------------------------------------|
+static scallop_lines_stats_t * scallop_lines_origin(scallop_lines_t * lines,
+                                                    size_t index)
+{
+    OBJECT_PRIV(scallop_, lines);
+
+    if (!priv->origins || index >= priv->count)
+    {
+        return NULL;
+    }
+
+    return priv->origins[index];
+}
+
+//------------------------------------------------------------------------|
+static void scallop_lines_ignore_origin(scallop_lines_t * lines)
+{
+    OBJECT_PRIV(scallop_, lines);
+    priv->ignore_origin = true;
+}
+
+//------------------------------------------------------------------------|
+const scallop_lines_t scallop_lines_pub = {
+    &scallop_lines_create,
+    &scallop_lines_destroy,
+    &scallop_lines_append,
+    &scallop_lines_count,
+    &scallop_lines_line,
+    &scallop_lines_length,
+    &scallop_lines_stats,
+    &scallop_lines_reset_stats,
+    &scallop_lines_set_origin,
+    &scallop_lines_origin,
+    &scallop_lines_ignore_origin,
+    NULL
+};
@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Execution statistics for a single stored line, kept while profiling.
+// Time is wall clock and includes anything the line dispatches, so the
+// line that closes a nested construct is charged for running its body.
+typedef struct
+{
+    size_t hits;
+    uint64_t total_ns;
+}
+scallop_lines_stats_t;
+
+//------------------------------------------------------------------------|
+// A scallop lines container holds the raw body of a routine, while loop,
+// if-else or any other construct that stores lines to be run later.  All
+// lines are packed end-to-end (each NUL terminated) into a single growable
+// buffer, with a parallel array of offsets marking where each one begins.
+// Appending is amortized O(1) and running a body is a sequential walk
+// through memory rather than a chase through linked-list nodes.
+typedef struct scallop_lines_t
+{
+    // Lines factory function
+    struct scallop_lines_t * (*create)();
+
+    // Lines destructor function
+    void (*destroy)(void * lines_ptr);
+
+    // Append a copy of a raw line to the end of the container
+    void (*append)(struct scallop_lines_t * lines, const char * line);
+
+    // Get the number of lines stored
+    size_t (*count)(struct scallop_lines_t * lines);
+
+    // Get a line by index, or NULL if the index is out of range.  The
+    // returned pointer is only valid until the next append.
+    const char * (*line)(struct scallop_lines_t * lines, size_t index);
+
+    // Get the length of a line by index, not including the terminator
+    size_t (*length)(struct scallop_lines_t * lines, size_t index);
+
+    // Get the statistics for a line by index, or NULL if the index is out
+    // of range.  Storage for these is only allocated on first use, so
+    // bodies that are never profiled pay nothing for them.  The returned
+    // pointer is only valid until the next append.
+    scallop_lines_stats_t * (*stats)(struct scallop_lines_t * lines,
+                                     size_t index);
+
+    // Clear the statistics for all lines
+    void (*reset_stats)(struct scallop_lines_t * lines);
+
+    // Set the statistics that lines appended from now on, to any lines
+    // container, are also charged to when they run.  This is how a loop
+    // body inside a routine reports back to the routine's own lines.
+    // The scallop engine sets this while running profiled lines.  Returns
+    // the previous origin so that it can be restored.
+    scallop_lines_stats_t * (*set_origin)(scallop_lines_stats_t * origin);
+
+    // Get the statistics that a line is also charged to, or NULL
+    scallop_lines_stats_t * (*origin)(struct scallop_lines_t * lines,
+                                      size_t index);
+
+    // Stop recording origins for lines appended to this container.
+    // Containers that can outlive the lines that fill them, such as
+    // routine bodies, must do this to avoid dangling references.
+    void (*ignore_origin)(struct scallop_lines_t * lines);
+
+    // Private data
+    void * priv;
+}
+scallop_lines_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_lines_t scallop_lines_pub;
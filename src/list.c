@@ -0,0 +1,198 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+#include "bytes.h"
+
+// Scallop
+#include "list.h"
+
+//------------------------------------------------------------------------|
+// Initial number of items allocated on first push
+#define SCALLOP_LIST_CAPACITY   8
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Contiguous array of item values
+    bytes_t ** items;
+    size_t length;
+    size_t capacity;
+}
+scallop_list_priv_t;
+
+//------------------------------------------------------------------------|
+// Map a possibly negative index onto the array, or return false
+static inline bool scallop_list_index(scallop_list_priv_t * priv,
+                                      long index,
+                                      size_t * offset)
+{
+    if (index < 0)
+    {
+        index += (long) priv->length;
+    }
+
+    if (index < 0 || (size_t) index >= priv->length)
+    {
+        return false;
+    }
+
+    *offset = (size_t) index;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static scallop_list_t * scallop_list_create()
+{
+    OBJECT_ALLOC(scallop_, list);
+    return list;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_list_destroy(void * list_ptr)
+{
+    OBJECT_PTR(scallop_, list, list_ptr, );
+
+    list->clear(list);
+    free(priv->items);
+
+    OBJECT_FREE(scallop_, list);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_list_push(scallop_list_t * list, const char * value)
+{
+    OBJECT_PRIV(scallop_, list);
+    bytes_t ** items = NULL;
+    size_t capacity = 0;
+
+    if (priv->length == priv->capacity)
+    {
+        capacity = priv->capacity ? 2 * priv->capacity : SCALLOP_LIST_CAPACITY;
+        items = (bytes_t **) realloc(priv->items, capacity * sizeof(*items));
+        if (!items)
+        {
+            BLAMMO(FATAL, "realloc(%zu) failed", capacity * sizeof(*items));
+            return false;
+        }
+
+        priv->items = items;
+        priv->capacity = capacity;
+    }
+
+    priv->items[priv->length] = bytes_pub.create(value, strlen(value));
+    if (!priv->items[priv->length])
+    {
+        BLAMMO(FATAL, "bytes_pub.create(%s) failed", value);
+        return false;
+    }
+
+    priv->length++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_list_pop(scallop_list_t * list)
+{
+    OBJECT_PRIV(scallop_, list);
+
+    if (priv->length == 0)
+    {
+        return false;
+    }
+
+    priv->length--;
+    priv->items[priv->length]->destroy(priv->items[priv->length]);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static const char * scallop_list_get(scallop_list_t * list, long index)
+{
+    OBJECT_PRIV(scallop_, list);
+    size_t offset = 0;
+
+    if (!scallop_list_index(priv, index, &offset))
+    {
+        return NULL;
+    }
+
+    return priv->items[offset]->cstr(priv->items[offset]);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_list_set(scallop_list_t * list,
+                             long index,
+                             const char * value)
+{
+    OBJECT_PRIV(scallop_, list);
+    size_t offset = 0;
+
+    if (!scallop_list_index(priv, index, &offset))
+    {
+        return false;
+    }
+
+    priv->items[offset]->assign(priv->items[offset], value, strlen(value));
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_list_length(scallop_list_t * list)
+{
+    OBJECT_PRIV(scallop_, list);
+    return priv->length;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_list_clear(scallop_list_t * list)
+{
+    OBJECT_PRIV(scallop_, list);
+
+    while (priv->length > 0)
+    {
+        priv->length--;
+        priv->items[priv->length]->destroy(priv->items[priv->length]);
+    }
+}
+
+//------------------------------------------------------------------------|
+const scallop_list_t scallop_list_pub = {
+    &scallop_list_create,
+    &scallop_list_destroy,
+    &scallop_list_push,
+    &scallop_list_pop,
+    &scallop_list_get,
+    &scallop_list_set,
+    &scallop_list_length,
+    &scallop_list_clear,
+    NULL
+};
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop list is an ordered array of string values held by a single
+// list variable.  Items are kept in one contiguous array, so indexing is
+// O(1) and pushing or popping at the end is amortized O(1).  Negative
+// indexes count back from the end, as in '{name[-1]}' for the last item.
+typedef struct scallop_list_t
+{
+    // List factory function
+    struct scallop_list_t * (*create)();
+
+    // List destructor function
+    void (*destroy)(void * list);
+
+    // Append a copy of a value to the end of the list
+    bool (*push)(struct scallop_list_t * list, const char * value);
+
+    // Remove the last item.  Returns false if the list is empty.
+    bool (*pop)(struct scallop_list_t * list);
+
+    // Get an item by index, or NULL if the index is out of range.  The
+    // returned pointer is only valid until the item is changed or removed.
+    const char * (*get)(struct scallop_list_t * list, long index);
+
+    // Replace an item by index.  Returns false if out of range.
+    bool (*set)(struct scallop_list_t * list, long index, const char * value);
+
+    // Get the number of items
+    size_t (*length)(struct scallop_list_t * list);
+
+    // Remove all items
+    void (*clear)(struct scallop_list_t * list);
+
+    // Private data
+    void * priv;
+}
+scallop_list_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_list_t scallop_list_pub;
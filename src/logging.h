@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "blammo.h"
+#include "logring.h"
+
+//------------------------------------------------------------------------|
+// Hot-path logging.  SCALLOP_LOG() takes the same arguments as BLAMMO(),
+// but calls below the compile-time floor SCALLOP_LOG_MIN (a blammo level,
+// 0=VERBOSE to 5=FATAL) compile to nothing, arguments and all.  Define
+// SCALLOP_LOG_RING to send the rest to the binary ring-buffer log rather
+// than blammo, so that no formatting happens until it is dumped.
+// Without either, SCALLOP_LOG() is a no-op like BLAMMO().
+#ifndef SCALLOP_LOG_MIN
+#define SCALLOP_LOG_MIN         VERBOSE
+#endif
+
+#if defined(SCALLOP_LOG_RING)
+#define SCALLOP_LOG_ON(level)   ((level) >= SCALLOP_LOG_MIN)
+#define SCALLOP_LOG(level, ...)                                     \
+    do {                                                            \
+        if (SCALLOP_LOG_ON(level))                                  \
+        {                                                           \
+            scallop_logring_record(level, __FILE__, __LINE__,       \
+                                   __VA_ARGS__);                    \
+        }                                                           \
+    } while (0)
+#elif defined(BLAMMO_ENABLE)
+#define SCALLOP_LOG_ON(level)   ((level) >= SCALLOP_LOG_MIN)
+#define SCALLOP_LOG(level, ...)                                     \
+    do {                                                            \
+        if (SCALLOP_LOG_ON(level))                                  \
+        {                                                           \
+            BLAMMO(level, __VA_ARGS__);                             \
+        }                                                           \
+    } while (0)
+#else
+#define SCALLOP_LOG_ON(level)   (0)
+#define SCALLOP_LOG(level, ...) do { } while (0)
+#endif
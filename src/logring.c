@@ -0,0 +1,421 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stddef.h>
+
+// Scallop
+#include "logring.h"
+#include "clock.h"
+#include "writer.h"
+
+//------------------------------------------------------------------------|
+// How a conversion's argument is stored, by its conversion character
+typedef enum
+{
+    SCALLOP_LOGRING_NONE = 0,
+    SCALLOP_LOGRING_SIGNED,
+    SCALLOP_LOGRING_UNSIGNED,
+    SCALLOP_LOGRING_CHAR,
+    SCALLOP_LOGRING_DOUBLE,
+    SCALLOP_LOGRING_POINTER,
+    SCALLOP_LOGRING_STRING
+}
+scallop_logring_kind_t;
+
+// One raw argument value.  Strings are an offset into the entry text.
+typedef union
+{
+    long long i;
+    unsigned long long u;
+    double d;
+    const void * p;
+}
+scallop_logring_arg_t;
+
+typedef struct
+{
+    uint64_t ns;
+    const char * file;
+    const char * fmt;
+    int line;
+    int level;
+    size_t nargs;
+    scallop_logring_arg_t args[SCALLOP_LOGRING_ARGS];
+    char text[SCALLOP_LOGRING_TEXT];
+}
+scallop_logring_entry_t;
+
+//------------------------------------------------------------------------|
+static scallop_logring_entry_t scallop_logring[SCALLOP_LOGRING_SIZE];
+static size_t scallop_logring_head = 0;
+static size_t scallop_logring_held = 0;
+
+// Writes entries to a file as they are recorded, when streaming
+static scallop_writer_t * scallop_logring_writer = NULL;
+static size_t scallop_logring_lost = 0;
+
+static const char * scallop_logring_levels[] = {
+    "VERBOSE", "DEBUG", "INFO", "WARNING", "ERROR", "FATAL"
+};
+
+//------------------------------------------------------------------------|
+// Parse one conversion specification following a '%'.  Returns the
+// character after it, and how its argument is stored.  Width and
+// precision given as '*' are counted in stars.
+static const char * scallop_logring_spec(const char * spec,
+                                         scallop_logring_kind_t * kind,
+                                         int * length,
+                                         size_t * stars)
+{
+    *kind = SCALLOP_LOGRING_NONE;
+    *length = 0;
+    *stars = 0;
+
+    // Flags, width and precision
+    while (*spec && strchr("-+ #0123456789.*", *spec))
+    {
+        *stars += (*spec == '*');
+        spec++;
+    }
+
+    // Length modifiers: only 'l' counts matter, as for "%ld" vs "%lld"
+    while (*spec && strchr("hlLqjzt", *spec))
+    {
+        *length += (*spec == 'l' || *spec == 'j' || *spec == 'z' ||
+                    *spec == 't' || *spec == 'q') ? 1 : 0;
+        spec++;
+    }
+
+    switch (*spec)
+    {
+        case 'd': case 'i':
+            *kind = SCALLOP_LOGRING_SIGNED;
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            *kind = SCALLOP_LOGRING_UNSIGNED;
+            break;
+        case 'c':
+            *kind = SCALLOP_LOGRING_CHAR;
+            break;
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+            *kind = SCALLOP_LOGRING_DOUBLE;
+            break;
+        case 'p':
+            *kind = SCALLOP_LOGRING_POINTER;
+            break;
+        case 's':
+            *kind = SCALLOP_LOGRING_STRING;
+            break;
+        default:
+            return spec;
+    }
+
+    return spec + 1;
+}
+
+//------------------------------------------------------------------------|
+void scallop_logring_record(int level,
+                            const char * file,
+                            int line,
+                            const char * fmt,
+                            ...)
+{
+    scallop_logring_entry_t * entry = &scallop_logring[scallop_logring_head];
+    scallop_logring_arg_t * arg = NULL;
+    scallop_logring_kind_t kind = SCALLOP_LOGRING_NONE;
+    const char * spec = fmt;
+    const char * string = NULL;
+    size_t text = 0;
+    size_t stars = 0;
+    size_t size = 0;
+    int length = 0;
+    va_list args;
+
+    entry->ns = scallop_clock_ns();
+    entry->file = file;
+    entry->fmt = fmt;
+    entry->line = line;
+    entry->level = level;
+    entry->nargs = 0;
+
+    // Walk the format only to pull each argument off as its own type
+    va_start(args, fmt);
+    while ((spec = strchr(spec, '%')) != NULL)
+    {
+        if (spec[1] == '%')
+        {
+            spec += 2;
+            continue;
+        }
+
+        spec = scallop_logring_spec(spec + 1, &kind, &length, &stars);
+        if (kind == SCALLOP_LOGRING_NONE ||
+            entry->nargs + stars + 1 > SCALLOP_LOGRING_ARGS)
+        {
+            break;
+        }
+
+        while (stars--)
+        {
+            entry->args[entry->nargs++].i = va_arg(args, int);
+        }
+
+        arg = &entry->args[entry->nargs++];
+        switch (kind)
+        {
+            case SCALLOP_LOGRING_SIGNED:
+                arg->i = length > 1 ? va_arg(args, long long) :
+                         length ? va_arg(args, long) : va_arg(args, int);
+                break;
+            case SCALLOP_LOGRING_UNSIGNED:
+                arg->u = length > 1 ? va_arg(args, unsigned long long) :
+                         length ? va_arg(args, unsigned long) :
+                         va_arg(args, unsigned int);
+                break;
+            case SCALLOP_LOGRING_CHAR:
+                arg->i = va_arg(args, int);
+                break;
+            case SCALLOP_LOGRING_DOUBLE:
+                arg->d = va_arg(args, double);
+                break;
+            case SCALLOP_LOGRING_POINTER:
+                arg->p = va_arg(args, const void *);
+                break;
+            case SCALLOP_LOGRING_STRING:
+                string = va_arg(args, const char *);
+                string = string ? string : "(null)";
+                size = strnlen(string, SCALLOP_LOGRING_TEXT - 1 - text);
+                memcpy(&entry->text[text], string, size);
+                entry->text[text + size] = '\0';
+                arg->u = text;
+                text += (text + size + 1 < SCALLOP_LOGRING_TEXT) ?
+                        size + 1 : size;
+                break;
+            default:
+                break;
+        }
+    }
+    va_end(args);
+
+    if (scallop_logring_writer)
+    {
+        scallop_logring_writer->push(scallop_logring_writer, entry);
+    }
+
+    scallop_logring_head = (scallop_logring_head + 1) % SCALLOP_LOGRING_SIZE;
+    if (scallop_logring_held < SCALLOP_LOGRING_SIZE)
+    {
+        scallop_logring_held++;
+    }
+}
+
+//------------------------------------------------------------------------|
+size_t scallop_logring_count()
+{
+    return scallop_logring_held;
+}
+
+//------------------------------------------------------------------------|
+void scallop_logring_clear()
+{
+    scallop_logring_head = 0;
+    scallop_logring_held = 0;
+}
+
+//------------------------------------------------------------------------|
+// Format one entry's message, one conversion at a time
+static void scallop_logring_print(FILE * file,
+                                  scallop_logring_entry_t * entry)
+{
+    scallop_logring_kind_t kind = SCALLOP_LOGRING_NONE;
+    scallop_logring_arg_t * arg = NULL;
+    const char * literal = entry->fmt;
+    const char * spec = entry->fmt;
+    const char * end = NULL;
+    const char * c = NULL;
+    char conversion[64];
+    size_t used = 0;
+    size_t index = 0;
+    size_t stars = 0;
+    int length = 0;
+
+    while ((spec = strchr(spec, '%')) != NULL)
+    {
+        if (spec[1] == '%')
+        {
+            fwrite(literal, 1, spec + 1 - literal, file);
+            literal = spec = spec + 2;
+            continue;
+        }
+
+        end = scallop_logring_spec(spec + 1, &kind, &length, &stars);
+        if (kind == SCALLOP_LOGRING_NONE ||
+            index + stars + 1 > entry->nargs ||
+            (size_t) (end - spec) > sizeof(conversion) / 2)
+        {
+            break;
+        }
+
+        fwrite(literal, 1, spec - literal, file);
+
+        // Keep flags, width and precision, filling in any '*' from the
+        // stored values, then convert as the value was stored.
+        conversion[0] = '%';
+        used = 1;
+        for (c = spec + 1; strchr("-+ #0123456789.*", *c); c++)
+        {
+            if (*c == '*')
+            {
+                used += snprintf(&conversion[used], sizeof(conversion) - used,
+                                 "%d", (int) entry->args[index++].i);
+            }
+            else
+            {
+                conversion[used++] = *c;
+            }
+        }
+
+        arg = &entry->args[index++];
+        switch (kind)
+        {
+            case SCALLOP_LOGRING_SIGNED:
+                snprintf(&conversion[used], sizeof(conversion) - used, "lld");
+                fprintf(file, conversion, arg->i);
+                break;
+            case SCALLOP_LOGRING_UNSIGNED:
+                snprintf(&conversion[used], sizeof(conversion) - used,
+                         "ll%c", end[-1]);
+                fprintf(file, conversion, arg->u);
+                break;
+            case SCALLOP_LOGRING_CHAR:
+                snprintf(&conversion[used], sizeof(conversion) - used, "c");
+                fprintf(file, conversion, (int) arg->i);
+                break;
+            case SCALLOP_LOGRING_DOUBLE:
+                snprintf(&conversion[used], sizeof(conversion) - used,
+                         "%c", end[-1]);
+                fprintf(file, conversion, arg->d);
+                break;
+            case SCALLOP_LOGRING_POINTER:
+                snprintf(&conversion[used], sizeof(conversion) - used, "p");
+                fprintf(file, conversion, arg->p);
+                break;
+            case SCALLOP_LOGRING_STRING:
+                snprintf(&conversion[used], sizeof(conversion) - used, "s");
+                fprintf(file, conversion, &entry->text[arg->u]);
+                break;
+            default:
+                break;
+        }
+
+        literal = spec = end;
+    }
+
+    fputs(literal, file);
+}
+
+//------------------------------------------------------------------------|
+// Write one entry as a line of text
+static void scallop_logring_write(FILE * file, const void * entry_ptr)
+{
+    scallop_logring_entry_t * entry = (scallop_logring_entry_t *) entry_ptr;
+
+    fprintf(file, "%llu.%09llu %s %s:%d ",
+            (unsigned long long) (entry->ns / 1000000000ULL),
+            (unsigned long long) (entry->ns % 1000000000ULL),
+            entry->level >= 0 && entry->level <= 5 ?
+            scallop_logring_levels[entry->level] : "?",
+            entry->file,
+            entry->line);
+    scallop_logring_print(file, entry);
+    fputc('\n', file);
+}
+
+//------------------------------------------------------------------------|
+bool scallop_logring_dump(const char * path)
+{
+    size_t oldest = (scallop_logring_head + SCALLOP_LOGRING_SIZE -
+                     scallop_logring_held) % SCALLOP_LOGRING_SIZE;
+    size_t index = 0;
+    bool success = true;
+
+    FILE * file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    for (index = 0; index < scallop_logring_held; index++)
+    {
+        scallop_logring_write(file,
+                &scallop_logring[(oldest + index) % SCALLOP_LOGRING_SIZE]);
+    }
+
+    success = !ferror(file);
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+
+    return success;
+}
+
+//------------------------------------------------------------------------|
+bool scallop_logring_stream(const char * path)
+{
+    if (scallop_logring_writer)
+    {
+        scallop_logring_lost += scallop_logring_writer->dropped(
+                scallop_logring_writer);
+        scallop_logring_writer->destroy(scallop_logring_writer);
+        scallop_logring_writer = NULL;
+    }
+
+    if (!path)
+    {
+        return true;
+    }
+
+    scallop_logring_writer = scallop_writer_pub.create(
+            path,
+            true,
+            sizeof(scallop_logring_entry_t),
+            SCALLOP_LOGRING_SIZE,
+            scallop_logring_write,
+            SCALLOP_WRITER_DROP);
+
+    return scallop_logring_writer != NULL;
+}
+
+//------------------------------------------------------------------------|
+size_t scallop_logring_dropped()
+{
+    return scallop_logring_lost + (scallop_logring_writer ?
+            scallop_logring_writer->dropped(scallop_logring_writer) : 0);
+}
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Number of entries held by the ring-buffer log.  Once full, the oldest
+// entries are overwritten.
+#ifndef SCALLOP_LOGRING_SIZE
+#define SCALLOP_LOGRING_SIZE    1024
+#endif
+
+// Most arguments kept per entry, and room for copies of string arguments
+#define SCALLOP_LOGRING_ARGS    8
+#define SCALLOP_LOGRING_TEXT    64
+
+//------------------------------------------------------------------------|
+// The ring-buffer log keeps each message as its format string pointer
+// and raw argument values in a static array, deferring all formatting
+// until the log is dumped.  Recording never allocates.  Strings are
+// copied (truncated) since they may not outlive the call.  Meant to be
+// reached through SCALLOP_LOG() built with SCALLOP_LOG_RING.
+
+// Record a message.  fmt must be a string literal, as with BLAMMO().
+void scallop_logring_record(int level,
+                            const char * file,
+                            int line,
+                            const char * fmt,
+                            ...);
+
+// Get the number of entries held
+size_t scallop_logring_count();
+
+// Discard all entries
+void scallop_logring_clear();
+
+// Format all entries held, oldest first, as text to a file.  Returns
+// false if the file could not be written.
+bool scallop_logring_dump(const char * path);
+
+// Also write each entry to a file, as text, as it is recorded.  Writing
+// is left to a background thread (see writer.h), so recording still never
+// waits on the file: entries are dropped instead if it falls more than
+// SCALLOP_LOGRING_SIZE behind.  NULL stops, once everything recorded has
+// been written.  Returns false if the file could not be opened.
+bool scallop_logring_stream(const char * path);
+
+// Get the number of entries dropped from the stream to a file
+size_t scallop_logring_dropped();
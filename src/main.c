@@ -28,6 +28,7 @@
 #include "command.h"
 #include "scallop.h"
 #include "builtin.h"
+#include "logring.h"
 
 //------------------------------------------------------------------------|
 typedef struct
@@ -46,6 +47,9 @@ typedef struct
 
     // Interactive CLI shell
     scallop_t * scallop;
+
+    // Read commands in blocks, bypassing the line editor
+    bool batch;
 }
 app_data_t;
 
@@ -99,6 +103,14 @@ void init(char * path)
     app->scallop = scallop_pub.create(app->console,
                                       register_builtin_commands,
                                       app->name);
+
+    // Nobody is typing at a pipe or file, so don't edit lines for it,
+    // and nobody is reading output line by line from one either.
+    app->batch = !isatty(STDIN_FILENO);
+    if (app->batch || !isatty(STDOUT_FILENO))
+    {
+        app->scallop->buffer_output(app->scallop, true);
+    }
 }
 
 //------------------------------------------------------------------------|
@@ -132,6 +144,9 @@ void quit(int status)
         app->console->destroy(app->console);
     }
 
+    // Write out whatever the log stream still has queued
+    scallop_logring_stream(NULL);
+
     exit(status);
 }
 
@@ -141,7 +156,7 @@ int parse(int argc, char *argv[])
     BLAMMO(INFO, "");
 
     char line[APP_BUFFER_SIZE] = { 0 };
-    const char * opts = "Vv:l:s:h";
+    const char * opts = "Vv:l:c:s:bh";
     int option;
     extern char * optarg;
 
@@ -168,6 +183,11 @@ int parse(int argc, char *argv[])
                 BLAMMO_FILE(optarg);
                 break;
 
+            case 'c':
+                // keep compiled scripts for any sourced after this
+                app->scallop->set_cache_dir(app->scallop, optarg);
+                break;
+
             case 's':
                 // load and run a script on startup
                 // TODO: ADD EXTRA UNPARSED ARGS HERE?
@@ -175,6 +195,12 @@ int parse(int argc, char *argv[])
                 app->scallop->dispatch(app->scallop, line);
                 break;
 
+            case 'b':
+                // batch mode, as for piped input
+                app->batch = true;
+                app->scallop->buffer_output(app->scallop, true);
+                break;
+
             case 'h':
             default:
                 usage(app->name, opts);
@@ -203,8 +229,16 @@ void usage(const char * name, const char * opts)
         "\r\n"
         "-l <path>     Set log file path (default is NULL)\r\n"
         "\r\n"
+        "-c <dir>      Keep compiled scripts in a cache directory, so that\r\n"
+        "              unchanged scripts start faster.  Give before -s.\r\n"
+        "\r\n"
         "-s <path>     Source a script file immediately on startup\r\n"
         "\r\n"
+        "-b            Batch mode: read commands from stdin in blocks, without\r\n"
+        "              line editing, history or prompts, and buffer output.\r\n"
+        "              This is the default when stdin is not a terminal.\r\n"
+        "              Output is also buffered when stdout is not one.\r\n"
+        "\r\n"
         "-h            Show this help text and quit\r\n"
         "\r\n" , name, opts);
 }
@@ -212,6 +246,11 @@ void usage(const char * name, const char * opts)
 //------------------------------------------------------------------------|
 int prompt()
 {
+    if (app->batch)
+    {
+        return app->scallop->run_batch(app->scallop, stdin);
+    }
+
     // enter interactive prompt
     return app->scallop->run_console(app->scallop, true);
 }
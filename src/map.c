@@ -0,0 +1,451 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "map.h"
+#include "hash.h"
+
+//------------------------------------------------------------------------|
+// Smallest table allocated.  Must be a power of two.
+#define SCALLOP_MAP_CAPACITY    16
+
+// Number of old table slots moved into the new one per modification
+// while a resize is in progress
+#define SCALLOP_MAP_MIGRATE     16
+
+// Marks a slot that is not found by searching
+#define SCALLOP_MAP_NONE        ((size_t) -1)
+
+//------------------------------------------------------------------------|
+// A slot with a NULL key is empty, and ends a probe sequence.  A slot
+// whose key is the tombstone once held a key, and does not.
+typedef struct
+{
+    char * key;
+    char * value;
+    size_t hash;
+}
+scallop_map_slot_t;
+
+typedef struct
+{
+    scallop_map_slot_t * slots;
+    size_t capacity;
+
+    // Number of live keys, and of slots that are not empty (live keys
+    // plus tombstones)
+    size_t used;
+    size_t filled;
+}
+scallop_map_table_t;
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // The table all new keys go into
+    scallop_map_table_t current;
+
+    // The table being drained into current during a resize, or empty.
+    // Slots before 'migrated' have all been moved.
+    scallop_map_table_t old;
+    size_t migrated;
+}
+scallop_map_priv_t;
+
+//------------------------------------------------------------------------|
+static char scallop_map_tombstone[1];
+
+//------------------------------------------------------------------------|
+static char * scallop_map_copy(const char * text)
+{
+    size_t size = strlen(text) + 1;
+    char * copy = (char *) malloc(size);
+
+    if (copy)
+    {
+        memcpy(copy, text, size);
+    }
+
+    return copy;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_map_table_init(scallop_map_table_t * table,
+                                   size_t capacity)
+{
+    table->slots = (scallop_map_slot_t *) calloc(capacity,
+                                                 sizeof(scallop_map_slot_t));
+    if (!table->slots)
+    {
+        BLAMMO(FATAL, "calloc(%zu) failed",
+                      capacity * sizeof(scallop_map_slot_t));
+        return false;
+    }
+
+    table->capacity = capacity;
+    table->used = 0;
+    table->filled = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_map_table_free(scallop_map_table_t * table)
+{
+    size_t index = 0;
+
+    for (index = 0; index < table->capacity; index++)
+    {
+        if (table->slots[index].key &&
+            table->slots[index].key != scallop_map_tombstone)
+        {
+            free(table->slots[index].key);
+            free(table->slots[index].value);
+        }
+    }
+
+    free(table->slots);
+    memzero(table, sizeof(*table));
+}
+
+//------------------------------------------------------------------------|
+// Find the slot holding a key, or SCALLOP_MAP_NONE
+static size_t scallop_map_table_find(scallop_map_table_t * table,
+                                     const char * key,
+                                     size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t index = hash & mask;
+    scallop_map_slot_t * slot = NULL;
+
+    if (!table->slots)
+    {
+        return SCALLOP_MAP_NONE;
+    }
+
+    // There is always at least one empty slot to end the search
+    for (slot = &table->slots[index]; slot->key; slot = &table->slots[index])
+    {
+        if (slot->key != scallop_map_tombstone &&
+            slot->hash == hash &&
+            !strcmp(slot->key, key))
+        {
+            return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return SCALLOP_MAP_NONE;
+}
+
+//------------------------------------------------------------------------|
+// Put a key known not to be in the table into its first free slot
+static void scallop_map_table_place(scallop_map_table_t * table,
+                                    char * key,
+                                    char * value,
+                                    size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t index = hash & mask;
+
+    while (table->slots[index].key &&
+           table->slots[index].key != scallop_map_tombstone)
+    {
+        index = (index + 1) & mask;
+    }
+
+    if (!table->slots[index].key)
+    {
+        table->filled++;
+    }
+
+    table->slots[index].key = key;
+    table->slots[index].value = value;
+    table->slots[index].hash = hash;
+    table->used++;
+}
+
+//------------------------------------------------------------------------|
+// Move up to count slots of the old table into the current one.  Moved
+// slots become tombstones so the old table can still be searched.
+static void scallop_map_migrate(scallop_map_priv_t * priv, size_t count)
+{
+    scallop_map_slot_t * slot = NULL;
+
+    while (priv->old.slots && count > 0)
+    {
+        slot = &priv->old.slots[priv->migrated];
+        if (slot->key && slot->key != scallop_map_tombstone)
+        {
+            scallop_map_table_place(&priv->current,
+                                    slot->key,
+                                    slot->value,
+                                    slot->hash);
+            slot->key = scallop_map_tombstone;
+            slot->value = NULL;
+            priv->old.used--;
+        }
+
+        priv->migrated++;
+        count--;
+
+        if (priv->migrated == priv->old.capacity)
+        {
+            free(priv->old.slots);
+            memzero(&priv->old, sizeof(priv->old));
+            priv->migrated = 0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------|
+// Make room for one more key in the current table, starting a resize if
+// it would be more than half full.  The new table is twice as large
+// unless most of the filled slots are only tombstones.
+static bool scallop_map_reserve(scallop_map_priv_t * priv)
+{
+    scallop_map_table_t table;
+    size_t capacity = priv->current.capacity;
+
+    if (2 * (priv->current.filled + 1) <= capacity)
+    {
+        return true;
+    }
+
+    // A resize still in progress must finish before another can begin
+    scallop_map_migrate(priv, SCALLOP_MAP_NONE);
+
+    if (4 * priv->current.used >= capacity)
+    {
+        capacity *= 2;
+    }
+
+    if (!scallop_map_table_init(&table, capacity))
+    {
+        return false;
+    }
+
+    priv->old = priv->current;
+    priv->current = table;
+    priv->migrated = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static scallop_map_t * scallop_map_create()
+{
+    OBJECT_ALLOC(scallop_, map);
+
+    if (!scallop_map_table_init(&priv->current, SCALLOP_MAP_CAPACITY))
+    {
+        map->destroy(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_map_destroy(void * map_ptr)
+{
+    OBJECT_PTR(scallop_, map, map_ptr, );
+
+    scallop_map_table_free(&priv->old);
+    scallop_map_table_free(&priv->current);
+
+    OBJECT_FREE(scallop_, map);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_map_set(scallop_map_t * map,
+                            const char * key,
+                            const char * value)
+{
+    OBJECT_PRIV(scallop_, map);
+    size_t hash = scallop_hash_string(key);
+    scallop_map_slot_t * slot = NULL;
+    char * keycopy = NULL;
+    char * valuecopy = scallop_map_copy(value);
+    size_t index = 0;
+
+    if (!valuecopy)
+    {
+        BLAMMO(FATAL, "scallop_map_copy(%s) failed", value);
+        return false;
+    }
+
+    scallop_map_migrate(priv, SCALLOP_MAP_MIGRATE);
+    if (!scallop_map_reserve(priv))
+    {
+        free(valuecopy);
+        return false;
+    }
+
+    // Replace the value in place when already current
+    index = scallop_map_table_find(&priv->current, key, hash);
+    if (index != SCALLOP_MAP_NONE)
+    {
+        slot = &priv->current.slots[index];
+        free(slot->value);
+        slot->value = valuecopy;
+        return true;
+    }
+
+    // Move it along early if not yet migrated, else it is a new key
+    index = scallop_map_table_find(&priv->old, key, hash);
+    if (index != SCALLOP_MAP_NONE)
+    {
+        slot = &priv->old.slots[index];
+        keycopy = slot->key;
+        free(slot->value);
+        slot->key = scallop_map_tombstone;
+        slot->value = NULL;
+        priv->old.used--;
+    }
+    else
+    {
+        keycopy = scallop_map_copy(key);
+        if (!keycopy)
+        {
+            BLAMMO(FATAL, "scallop_map_copy(%s) failed", key);
+            free(valuecopy);
+            return false;
+        }
+    }
+
+    scallop_map_table_place(&priv->current, keycopy, valuecopy, hash);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static const char * scallop_map_get(scallop_map_t * map, const char * key)
+{
+    OBJECT_PRIV(scallop_, map);
+    size_t hash = scallop_hash_string(key);
+    size_t index = scallop_map_table_find(&priv->current, key, hash);
+
+    if (index != SCALLOP_MAP_NONE)
+    {
+        return priv->current.slots[index].value;
+    }
+
+    index = scallop_map_table_find(&priv->old, key, hash);
+    if (index != SCALLOP_MAP_NONE)
+    {
+        return priv->old.slots[index].value;
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_map_remove(scallop_map_t * map, const char * key)
+{
+    OBJECT_PRIV(scallop_, map);
+    size_t hash = scallop_hash_string(key);
+    scallop_map_table_t * table = &priv->current;
+    size_t index = 0;
+
+    scallop_map_migrate(priv, SCALLOP_MAP_MIGRATE);
+
+    index = scallop_map_table_find(table, key, hash);
+    if (index == SCALLOP_MAP_NONE)
+    {
+        table = &priv->old;
+        index = scallop_map_table_find(table, key, hash);
+    }
+
+    if (index == SCALLOP_MAP_NONE)
+    {
+        return false;
+    }
+
+    free(table->slots[index].key);
+    free(table->slots[index].value);
+    table->slots[index].key = scallop_map_tombstone;
+    table->slots[index].value = NULL;
+    table->used--;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_map_size(scallop_map_t * map)
+{
+    OBJECT_PRIV(scallop_, map);
+    return priv->current.used + priv->old.used;
+}
+
+//------------------------------------------------------------------------|
+// The cursor runs through the current table's slots, then the old's
+static bool scallop_map_next(scallop_map_t * map,
+                             size_t * cursor,
+                             const char ** key,
+                             const char ** value)
+{
+    OBJECT_PRIV(scallop_, map);
+    scallop_map_slot_t * slot = NULL;
+
+    while (*cursor < priv->current.capacity + priv->old.capacity)
+    {
+        if (*cursor < priv->current.capacity)
+        {
+            slot = &priv->current.slots[*cursor];
+        }
+        else
+        {
+            slot = &priv->old.slots[*cursor - priv->current.capacity];
+        }
+
+        (*cursor)++;
+        if (slot->key && slot->key != scallop_map_tombstone)
+        {
+            *key = slot->key;
+            *value = slot->value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------|
+const scallop_map_t scallop_map_pub = {
+    &scallop_map_create,
+    &scallop_map_destroy,
+    &scallop_map_set,
+    &scallop_map_get,
+    &scallop_map_remove,
+    &scallop_map_size,
+    &scallop_map_next,
+    NULL
+};
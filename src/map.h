@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop map holds string values by string key for a single map
+// variable.  It is an open-addressed hash table with linear probing.
+// Growing the table does not rehash everything at once: the new table is
+// filled a few slots at a time by each following operation, while lookups
+// check both, so a large map never stalls a single dispatch.
+typedef struct scallop_map_t
+{
+    // Map factory function
+    struct scallop_map_t * (*create)();
+
+    // Map destructor function
+    void (*destroy)(void * map);
+
+    // Set a copy of a value by key, replacing any existing value
+    bool (*set)(struct scallop_map_t * map,
+                const char * key,
+                const char * value);
+
+    // Get a value by key, or NULL if not found.  The returned pointer is
+    // only valid until the map is next modified.
+    const char * (*get)(struct scallop_map_t * map, const char * key);
+
+    // Remove a value by key.  Returns false if not found.
+    bool (*remove)(struct scallop_map_t * map, const char * key);
+
+    // Get the number of keys
+    size_t (*size)(struct scallop_map_t * map);
+
+    // Iterate over all keys in no particular order.  Start with *cursor
+    // at zero, and call until false is returned.  The map must not be
+    // modified in between calls.
+    bool (*next)(struct scallop_map_t * map,
+                 size_t * cursor,
+                 const char ** key,
+                 const char ** value);
+
+    // Private data
+    void * priv;
+}
+scallop_map_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_map_t scallop_map_pub;
@@ -0,0 +1,366 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "memo.h"
+#include "hash.h"
+
+//------------------------------------------------------------------------|
+// Sentinel index for empty hash buckets and list ends
+#define SCALLOP_MEMO_NONE       ((size_t) -1)
+
+//------------------------------------------------------------------------|
+// A single cached key/result pair.  Entries live in one fixed array and
+// are linked to each other by index rather than by pointer.
+typedef struct
+{
+    // Owned copy of the key and its precomputed hash
+    char * key;
+    size_t size;
+    size_t hash;
+
+    // The cached result
+    int result;
+
+    // Next entry in the same hash bucket
+    size_t chain;
+
+    // Neighbors in recency order (head is most recently used)
+    size_t newer;
+    size_t older;
+}
+scallop_memo_entry_t;
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Fixed array of entries, of which 'used' are populated
+    scallop_memo_entry_t * entries;
+    size_t capacity;
+    size_t used;
+
+    // Hash bucket heads.  Twice the capacity keeps chains short.
+    size_t * buckets;
+    size_t nbuckets;
+
+    // Most and least recently used entries
+    size_t newest;
+    size_t oldest;
+
+    // Statistics
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+}
+scallop_memo_priv_t;
+
+//------------------------------------------------------------------------|
+static void scallop_memo_reset(scallop_memo_priv_t * priv)
+{
+    size_t index = 0;
+
+    for (index = 0; index < priv->nbuckets; index++)
+    {
+        priv->buckets[index] = SCALLOP_MEMO_NONE;
+    }
+
+    priv->used = 0;
+    priv->newest = SCALLOP_MEMO_NONE;
+    priv->oldest = SCALLOP_MEMO_NONE;
+}
+
+//------------------------------------------------------------------------|
+static scallop_memo_t * scallop_memo_create(size_t capacity)
+{
+    OBJECT_ALLOC(scallop_, memo);
+
+    priv->capacity = capacity ? capacity : 1;
+    priv->entries = (scallop_memo_entry_t *)
+            calloc(priv->capacity, sizeof(scallop_memo_entry_t));
+    if (!priv->entries)
+    {
+        BLAMMO(FATAL, "calloc(%zu) entries failed", priv->capacity);
+        memo->destroy(memo);
+        return NULL;
+    }
+
+    priv->nbuckets = priv->capacity * 2;
+    priv->buckets = (size_t *) malloc(priv->nbuckets * sizeof(size_t));
+    if (!priv->buckets)
+    {
+        BLAMMO(FATAL, "malloc(%zu) buckets failed", priv->nbuckets);
+        memo->destroy(memo);
+        return NULL;
+    }
+
+    scallop_memo_reset(priv);
+    return memo;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_memo_destroy(void * memo_ptr)
+{
+    OBJECT_PTR(scallop_, memo, memo_ptr, );
+    size_t index = 0;
+
+    if (priv->entries)
+    {
+        for (index = 0; index < priv->used; index++)
+        {
+            free(priv->entries[index].key);
+        }
+
+        free(priv->entries);
+    }
+
+    if (priv->buckets)
+    {
+        free(priv->buckets);
+    }
+
+    OBJECT_FREE(scallop_, memo);
+}
+
+//------------------------------------------------------------------------|
+// Unlink an entry from the recency list
+static void scallop_memo_detach(scallop_memo_priv_t * priv, size_t index)
+{
+    scallop_memo_entry_t * entry = &priv->entries[index];
+
+    if (entry->newer != SCALLOP_MEMO_NONE)
+    {
+        priv->entries[entry->newer].older = entry->older;
+    }
+    else
+    {
+        priv->newest = entry->older;
+    }
+
+    if (entry->older != SCALLOP_MEMO_NONE)
+    {
+        priv->entries[entry->older].newer = entry->newer;
+    }
+    else
+    {
+        priv->oldest = entry->newer;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Link an entry in as the most recently used
+static void scallop_memo_attach(scallop_memo_priv_t * priv, size_t index)
+{
+    scallop_memo_entry_t * entry = &priv->entries[index];
+
+    entry->newer = SCALLOP_MEMO_NONE;
+    entry->older = priv->newest;
+
+    if (priv->newest != SCALLOP_MEMO_NONE)
+    {
+        priv->entries[priv->newest].newer = index;
+    }
+
+    priv->newest = index;
+
+    if (priv->oldest == SCALLOP_MEMO_NONE)
+    {
+        priv->oldest = index;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Find an entry by key, returning its index or SCALLOP_MEMO_NONE
+static size_t scallop_memo_find(scallop_memo_priv_t * priv,
+                                const char * key,
+                                size_t size,
+                                size_t hash)
+{
+    size_t index = priv->buckets[hash % priv->nbuckets];
+
+    while (index != SCALLOP_MEMO_NONE)
+    {
+        scallop_memo_entry_t * entry = &priv->entries[index];
+        if (entry->hash == hash && entry->size == size &&
+                !memcmp(entry->key, key, size))
+        {
+            return index;
+        }
+
+        index = entry->chain;
+    }
+
+    return SCALLOP_MEMO_NONE;
+}
+
+//------------------------------------------------------------------------|
+// Remove an entry from its hash bucket chain
+static void scallop_memo_unhash(scallop_memo_priv_t * priv, size_t index)
+{
+    size_t * link = &priv->buckets[priv->entries[index].hash % priv->nbuckets];
+
+    while (*link != SCALLOP_MEMO_NONE)
+    {
+        if (*link == index)
+        {
+            *link = priv->entries[index].chain;
+            return;
+        }
+
+        link = &priv->entries[*link].chain;
+    }
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_memo_lookup(scallop_memo_t * memo,
+                                const char * key,
+                                size_t size,
+                                int * result)
+{
+    OBJECT_PRIV(scallop_, memo);
+    size_t hash = scallop_hash_bytes(key, size);
+    size_t index = scallop_memo_find(priv, key, size, hash);
+
+    if (index == SCALLOP_MEMO_NONE)
+    {
+        priv->misses++;
+        return false;
+    }
+
+    // Refresh recency
+    scallop_memo_detach(priv, index);
+    scallop_memo_attach(priv, index);
+
+    priv->hits++;
+    *result = priv->entries[index].result;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_memo_store(scallop_memo_t * memo,
+                               const char * key,
+                               size_t size,
+                               int result)
+{
+    OBJECT_PRIV(scallop_, memo);
+    size_t hash = scallop_hash_bytes(key, size);
+    size_t index = scallop_memo_find(priv, key, size, hash);
+    scallop_memo_entry_t * entry = NULL;
+
+    // Already present (possibly stored by a recursive call): refresh it
+    if (index != SCALLOP_MEMO_NONE)
+    {
+        priv->entries[index].result = result;
+        scallop_memo_detach(priv, index);
+        scallop_memo_attach(priv, index);
+        return;
+    }
+
+    // Take a free slot if there is one, otherwise evict the oldest
+    if (priv->used < priv->capacity)
+    {
+        index = priv->used++;
+    }
+    else
+    {
+        index = priv->oldest;
+        scallop_memo_detach(priv, index);
+        scallop_memo_unhash(priv, index);
+        free(priv->entries[index].key);
+        priv->entries[index].key = NULL;
+        priv->evictions++;
+    }
+
+    entry = &priv->entries[index];
+    entry->key = (char *) malloc(size ? size : 1);
+    if (!entry->key)
+    {
+        // The slot is now detached from everything.  Rather than try to
+        // patch the hole, just forget the whole cache.
+        BLAMMO(FATAL, "malloc(%zu) key failed", size);
+        memo->clear(memo);
+        return;
+    }
+
+    memcpy(entry->key, key, size);
+    entry->size = size;
+    entry->hash = hash;
+    entry->result = result;
+
+    entry->chain = priv->buckets[hash % priv->nbuckets];
+    priv->buckets[hash % priv->nbuckets] = index;
+    scallop_memo_attach(priv, index);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_memo_clear(scallop_memo_t * memo)
+{
+    OBJECT_PRIV(scallop_, memo);
+    size_t index = 0;
+
+    for (index = 0; index < priv->used; index++)
+    {
+        free(priv->entries[index].key);
+        priv->entries[index].key = NULL;
+    }
+
+    scallop_memo_reset(priv);
+    priv->hits = 0;
+    priv->misses = 0;
+    priv->evictions = 0;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_memo_stats(scallop_memo_t * memo,
+                               size_t * entries,
+                               size_t * hits,
+                               size_t * misses,
+                               size_t * evictions)
+{
+    OBJECT_PRIV(scallop_, memo);
+
+    if (entries) { *entries = priv->used; }
+    if (hits) { *hits = priv->hits; }
+    if (misses) { *misses = priv->misses; }
+    if (evictions) { *evictions = priv->evictions; }
+}
+
+//------------------------------------------------------------------------|
+const scallop_memo_t scallop_memo_pub = {
+    &scallop_memo_create,
+    &scallop_memo_destroy,
+    &scallop_memo_lookup,
+    &scallop_memo_store,
+    &scallop_memo_clear,
+    &scallop_memo_stats,
+    NULL
+};
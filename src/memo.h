@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop memo is a bounded least-recently-used cache that maps an
+// opaque key (normally the packed argument vector of a routine call) to
+// the integer result that call produced.  Lookups and stores are O(1):
+// entries are found through a small chained hash table and kept in
+// recency order on an intrusive doubly-linked list.  When full, the least
+// recently used entry is evicted to make room.
+typedef struct scallop_memo_t
+{
+    // Memo factory function.  Capacity is the maximum number of entries.
+    struct scallop_memo_t * (*create)(size_t capacity);
+
+    // Memo destructor function
+    void (*destroy)(void * memo_ptr);
+
+    // Look up a key.  On a hit, stores the cached result and returns true.
+    bool (*lookup)(struct scallop_memo_t * memo,
+                   const char * key,
+                   size_t size,
+                   int * result);
+
+    // Store (or refresh) the result for a key
+    void (*store)(struct scallop_memo_t * memo,
+                  const char * key,
+                  size_t size,
+                  int result);
+
+    // Discard all entries and reset statistics
+    void (*clear)(struct scallop_memo_t * memo);
+
+    // Get usage statistics.  Any pointer may be NULL if not needed.
+    void (*stats)(struct scallop_memo_t * memo,
+                  size_t * entries,
+                  size_t * hits,
+                  size_t * misses,
+                  size_t * evictions);
+
+    // Private data
+    void * priv;
+}
+scallop_memo_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_memo_t scallop_memo_pub;
@@ -31,14 +31,23 @@
 #include "utils.h"              // memzero()
 #include "blammo.h"
 #include "console.h"
-#include "chain.h"
 #include "bytes.h"
 
 // Scallop
 #include "scallop.h"
 #include "command.h"
+#include "lines.h"
+#include "memo.h"
 #include "routine.h"
 
+//------------------------------------------------------------------------|
+// Maximum number of distinct argument vectors remembered per pure routine
+#define SCALLOP_RTN_MEMO_CAPACITY       256
+
+// Separates arguments within a memo key.  The ASCII unit separator is
+// never going to show up inside a tokenized argument.
+static const char scallop_rtn_memo_delim = '\x1f';
+
 //------------------------------------------------------------------------|
 typedef struct
 {
@@ -46,7 +55,13 @@ typedef struct
     bytes_t * name;
 
     // Raw command lines consisting of the routine body
-    chain_t * lines;
+    scallop_lines_t * lines;
+
+    // Result cache for pure routines.  NULL for ordinary routines.
+    scallop_memo_t * memo;
+
+    // Scratch buffer for building memo keys out of argument vectors
+    bytes_t * memo_key;
 }
 scallop_rtn_priv_t;
 
@@ -67,15 +82,17 @@ static scallop_rtn_t * scallop_rtn_create(const char * name)
     // List of raw (mostly) uninterpreted command lines consisting
     // of the body of the routine.  One exception to this is we'll
     // need to track the nested depth of an 'end' keyword (multi-use)
-    priv->lines = chain_pub.create(bytes_pub.copy,
-                                   bytes_pub.destroy);
+    priv->lines = scallop_lines_pub.create();
     if (!priv->lines)
     {
-        BLAMMO(FATAL, "chain_pub.create() failed");
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
         rtn->destroy(rtn);
         return NULL;
     }
 
+    // A routine outlives whatever lines defined it
+    priv->lines->ignore_origin(priv->lines);
+
     return rtn;
 }
 
@@ -84,6 +101,16 @@ static void scallop_rtn_destroy(void * rtn_ptr)
 {
     OBJECT_PTR(scallop_, rtn, rtn_ptr, );
 
+    if (priv->memo_key)
+    {
+        priv->memo_key->destroy(priv->memo_key);
+    }
+
+    if (priv->memo)
+    {
+        priv->memo->destroy(priv->memo);
+    }
+
     if (priv->lines)
     {
         priv->lines->destroy(priv->lines);
@@ -119,16 +146,84 @@ static inline const char * scallop_rtn_name(scallop_rtn_t * rtn)
 static void scallop_rtn_append(scallop_rtn_t * rtn, const char * line)
 {
     OBJECT_PRIV(scallop_, rtn);
+    priv->lines->append(priv->lines, line);
+}
 
-    // First create the line object
-    bytes_t * linebytes = bytes_pub.create(line, strlen(line));
+//------------------------------------------------------------------------|
+static bool scallop_rtn_set_pure(scallop_rtn_t * rtn, bool pure)
+{
+    OBJECT_PRIV(scallop_, rtn);
 
-    // Make no assumptions about the state of the chain, but always
-    // force the insert at the 'end' of the chain, which is always at -1
-    // since the chain is circular.
-    priv->lines->reset(priv->lines);
-    priv->lines->spin(priv->lines, -1);
-    priv->lines->insert(priv->lines, linebytes);
+    if (!pure)
+    {
+        if (priv->memo)
+        {
+            priv->memo->destroy(priv->memo);
+            priv->memo = NULL;
+        }
+
+        return true;
+    }
+
+    if (priv->memo)
+    {
+        return true;
+    }
+
+    priv->memo = scallop_memo_pub.create(SCALLOP_RTN_MEMO_CAPACITY);
+    if (!priv->memo)
+    {
+        BLAMMO(ERROR, "scallop_memo_pub.create() failed");
+        return false;
+    }
+
+    if (!priv->memo_key)
+    {
+        priv->memo_key = bytes_pub.create(NULL, 0);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static inline bool scallop_rtn_is_pure(scallop_rtn_t * rtn)
+{
+    OBJECT_PRIV(scallop_, rtn);
+    return priv->memo != NULL;
+}
+
+//------------------------------------------------------------------------|
+static inline void * scallop_rtn_memo(scallop_rtn_t * rtn)
+{
+    OBJECT_PRIV(scallop_, rtn);
+    return priv->memo;
+}
+
+//------------------------------------------------------------------------|
+static inline void * scallop_rtn_lines(scallop_rtn_t * rtn)
+{
+    OBJECT_PRIV(scallop_, rtn);
+    return priv->lines;
+}
+
+//------------------------------------------------------------------------|
+// Pack an argument vector into the scratch memo key buffer
+static void scallop_rtn_memo_key(scallop_rtn_priv_t * priv,
+                                 int argc,
+                                 char ** args)
+{
+    int arg_num = 0;
+
+    priv->memo_key->resize(priv->memo_key, 0);
+    for (arg_num = 1; arg_num < argc; arg_num++)
+    {
+        priv->memo_key->append(priv->memo_key,
+                               args[arg_num],
+                               strlen(args[arg_num]));
+        priv->memo_key->append(priv->memo_key,
+                               &scallop_rtn_memo_delim,
+                               1);
+    }
 }
 
 //------------------------------------------------------------------------|
@@ -160,13 +255,48 @@ static int scallop_rtn_handler(void * scmd,
         return -1;
     }
 
+    OBJECT_PRIV(scallop_, rtn);
+    int result = 0;
+
+    // Pure routines first check whether this exact argument vector
+    // has been seen before.  args[0] is always the routine name, so
+    // only the arguments following it make up the key.
+    if (priv->memo)
+    {
+        scallop_rtn_memo_key(priv, argc, args);
+        if (priv->memo->lookup(priv->memo,
+                               priv->memo_key->cstr(priv->memo_key),
+                               priv->memo_key->size(priv->memo_key),
+                               &result))
+        {
+            BLAMMO(DEBUG, "memo hit for routine %s", cmd->keyword(cmd));
+            return result;
+        }
+    }
+
     // Store subroutine arguments in scallop's variable
     // collection so dispatch can perform substitution.
     scallop->store_args(scallop, argc, args);
 
-    OBJECT_PRIV(scallop_, rtn);
+    result = scallop->run_lines(scallop, priv->lines);
+
+    // The routine boundary consumes any 'return', and also any stray
+    // 'break' or 'continue' that was not inside a loop.
+    scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+
+    // Remember the result, unless the routine failed.  The key has to be
+    // rebuilt because a recursive call to this same routine will have
+    // reused the scratch buffer.
+    if (priv->memo && result != ERROR_MARKER_DEC)
+    {
+        scallop_rtn_memo_key(priv, argc, args);
+        priv->memo->store(priv->memo,
+                          priv->memo_key->cstr(priv->memo_key),
+                          priv->memo_key->size(priv->memo_key),
+                          result);
+    }
 
-    return scallop->run_lines(scallop, priv->lines);
+    return result;
 }
 
 //------------------------------------------------------------------------|
@@ -176,6 +306,10 @@ const scallop_rtn_t scallop_rtn_pub = {
     &scallop_rtn_compare_name,
     &scallop_rtn_name,
     &scallop_rtn_append,
+    &scallop_rtn_set_pure,
+    &scallop_rtn_is_pure,
+    &scallop_rtn_memo,
+    &scallop_rtn_lines,
     &scallop_rtn_handler,
     NULL
 };
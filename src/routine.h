@@ -51,6 +51,22 @@ typedef struct scallop_rtn_t
     // Append a line to the routine
     void (*append)(struct scallop_rtn_t * rtn, const char * line);
 
+    // Declare the routine pure (or not).  A pure routine's result depends
+    // only on its arguments, so results are memoized per argument vector
+    // and repeat calls skip running the body entirely.
+    bool (*set_pure)(struct scallop_rtn_t * rtn, bool pure);
+
+    // Get whether the routine is pure
+    bool (*is_pure)(struct scallop_rtn_t * rtn);
+
+    // Get the memo cache of a pure routine, or NULL if not pure.
+    // This is declared void * to avoid exposing memo.h to every user.
+    void * (*memo)(struct scallop_rtn_t * rtn);
+
+    // Get the stored body of the routine, as for an annotated listing.
+    // This is declared void * but is always a scallop_lines_t *.
+    void * (*lines)(struct scallop_rtn_t * rtn);
+
     // Execute the routine with arguments
     int (*handler)(void * scmd, void * context, int argc, char ** args);
 
@@ -27,6 +27,10 @@
 #include <string.h>
 #include <stddef.h>
 #include <errno.h>
+#include <unistd.h>             // read()
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // RayCO
 #include "utils.h"              // memzero(), function signatures
@@ -41,7 +45,14 @@
 #include "command.h"
 #include "builtin.h"
 #include "routine.h"
+#include "lines.h"
+#include "list.h"
+#include "map.h"
 #include "parser.h"
+#include "clock.h"
+#include "logging.h"
+#include "stream.h"
+#include "hash.h"
 
 //------------------------------------------------------------------------|
 // Various constants that define the syntax/dialect/behavior of scallop's
@@ -63,6 +74,27 @@ static const char * scallop_cmd_delim = " \t\n\r\f\v";
 // The string that designates everything to the right as a comment.
 static const char * scallop_cmd_comment = "#";
 
+// Separates the commands of a pipeline, where each command's output is
+// the input of the next.  Doubled, it is left alone as logical 'or'.
+static const char scallop_pipe = '|';
+
+// Sends a command's output to the file named after it, replacing the
+// file, or appending to it when doubled.
+static const char scallop_redirect = '>';
+
+// Size of each block read in batch mode.  Longer lines grow the buffer.
+#define SCALLOP_BATCH_BLOCK     65536
+
+// Size of the console output buffer when buffering output
+#define SCALLOP_OUTPUT_BUFFER   65536
+
+// Longest keyword in a path given to invoke_path(), or remembered by
+// dispatch_batch() after looking it up
+#define SCALLOP_MAX_KEYWORD     64
+
+// Number of commands dispatch_batch() remembers, by keyword hash
+#define SCALLOP_RESOLVED_SIZE   32
+
 // The begin/end markers for variable and argument substitution in
 // unparsed command lines and routine arguments.  Whitespace between
 // brackets may produce unexpected behavior!
@@ -81,6 +113,60 @@ static const char * scallop_encaps_pairs[] = {
     NULL
 };
 
+//------------------------------------------------------------------------|
+// A variable name bound directly to a native integer, as by a for loop,
+// or to the item of a list at such an index, as by a foreach loop.  The
+// list is held by name, since the loop body is free to replace or remove
+// it.  Assigning the name writes through to the counter or the item.  No
+// member is owned by the binding.
+typedef struct
+{
+    const char * name;
+    long * counter;
+    const char * list;
+}
+scallop_binding_t;
+
+//------------------------------------------------------------------------|
+// A host callback that computes a variable's value when referenced.  With
+// cache, the value computed is reused until the next line is dispatched.
+typedef struct
+{
+    scallop_provider_f provider;
+    void * object;
+    bool cache;
+    bytes_t * value;
+    size_t dispatches;
+    bool computed;
+}
+scallop_provider_t;
+
+//------------------------------------------------------------------------|
+// A top-level command as last looked up by its keyword
+typedef struct
+{
+    char keyword[SCALLOP_MAX_KEYWORD + 1];
+    scallop_cmd_t * command;
+}
+scallop_resolved_t;
+
+// Scratch state shared by all the lines of a dispatch_batch(), rather
+// than made and destroyed for each one.  The outermost line is copied
+// into line, and substitution works in varname and value, each of which
+// only ever grows.  Commands looked up are remembered for as long as the
+// command registry doesn't change.
+typedef struct
+{
+    bytes_t * line;
+    bytes_t * varname;
+    bytes_t * value;
+    bool substituting;
+
+    size_t changes;
+    scallop_resolved_t resolved[SCALLOP_RESOLVED_SIZE];
+}
+scallop_arena_t;
+
 //------------------------------------------------------------------------|
 // scallop private implementation data
 typedef struct
@@ -88,9 +174,47 @@ typedef struct
     // set true to break out of main loop
     bool quit;
 
+    // Directory for compiled scripts, or NULL to always source directly
+    char * cache_dir;
+
+    // While buffering output, the stream of our own the console writes
+    // to instead, the buffer it was given, and the console's own stream
+    // to go back to.  All NULL otherwise.
+    FILE * output_stream;
+    char * output_buffer;
+    FILE * output_restore;
+
     // Recursion depth for when executing scripts/procedures
     size_t depth;
 
+    // The most recent dispatch result, as also stored in "%?"
+    int result;
+
+    // Total number of dispatch() calls
+    size_t dispatches;
+
+    // Running from run_batch(), where there is no prompt to keep up
+    bool batch;
+
+    // Shared scratch state while in dispatch_batch(), NULL otherwise
+    scallop_arena_t * arena;
+
+    // Output of the previous command in the pipeline being run, if any,
+    // and whether the next line dispatched is a single command having its
+    // output captured, as part of a pipeline or redirected.
+    scallop_stream_t * input;
+    bool stage;
+
+    // How many run_lines() calls are nested, and whether any of them
+    // has been asked to stop early.
+    size_t running;
+    scallop_unwind_t unwind;
+
+    // Stack of loop variables bound by name.  Each nested loop takes a
+    // dispatch level, so the recursion limit also bounds this.
+    scallop_binding_t bindings[SCALLOP_MAX_RECURS];
+    size_t nbindings;
+
     // There is intent to port this code to cc65 to target the C64
     // and possibly the Commander X16.  The cc65 compiler _does_ have
     // putenv() and getenv(), which I was tempted to use for all
@@ -101,6 +225,23 @@ typedef struct
     // remain more portable that way.
     collect_t * variables;
 
+    // Names of the variables assigned, as opposed to arguments and the
+    // result, since the collection above can't be iterated.  A name is
+    // only added when its variable is created, never on reassignment.
+    // The values here are unused.
+    scallop_map_t * assigned;
+
+    // Variable providers (scallop_provider_t *) by name, and how many
+    // there are, so that references needn't look when there are none.
+    collect_t * providers;
+    size_t nproviders;
+
+    // List variables (scallop_list_t *) and map variables
+    // (scallop_map_t *) by name.  These are kept apart from the scalar
+    // variables above so that none of them needs a type tag.
+    collect_t * lists;
+    collect_t * maps;
+
     // Language construct stack used to keep track of nested routine
     // definitions, while loops, if-else and any other construct that
     // requires a beginning and end keyword with body in between that
@@ -122,6 +263,11 @@ typedef struct
 
     // Pointer to the console object for user I/O
     console_t * console;
+
+    // Trace event recorder, created on the first trace start
+    scallop_trace_t * trace;
+    size_t trace_capacity;
+    bool tracing;
 }
 scallop_priv_t;
 
@@ -157,6 +303,22 @@ typedef struct
 }
 scallop_construct_t;
 
+//------------------------------------------------------------------------|
+// Record a trace event at the current dispatch depth, if tracing
+static inline void scallop_trace_event(scallop_priv_t * priv,
+                                       char phase,
+                                       scallop_trace_track_t track,
+                                       const char * category,
+                                       const char * name,
+                                       size_t size)
+{
+    if (priv->tracing)
+    {
+        priv->trace->record(priv->trace, phase, track, category,
+                            name, size, priv->depth);
+    }
+}
+
 //------------------------------------------------------------------------|
 // trivial language construct copy function for chain inclusion
 static void * scallop_construct_copy(const void * construct)
@@ -178,7 +340,7 @@ static void * scallop_construct_copy(const void * construct)
 //------------------------------------------------------------------------|
 static void scallop_tab_completion(void * object, const char * buffer)
 {
-    BLAMMO(DEBUG, "buffer: \'%s\'", buffer);
+    SCALLOP_LOG(DEBUG, "buffer: \'%s\'", buffer);
 
     // Always get a handle on the singleton scallop
     OBJECT_PTR(, scallop, object, );
@@ -219,15 +381,15 @@ static void scallop_tab_completion(void * object, const char * buffer)
         command = priv->commands->find_by_keyword(parent, args[nest]);
         if (!command)
         {
-            BLAMMO(DEBUG, "Command %s not found", args[nest]);
+            SCALLOP_LOG(DEBUG, "Command %s not found", args[nest]);
             break;
         }
 
-        BLAMMO(DEBUG, "Command %s found!", args[nest]);
+        SCALLOP_LOG(DEBUG, "Command %s found!", args[nest]);
         parent = command;
     }
 
-    BLAMMO(DEBUG, "parent keyword: %s  args[%d]: %s",
+    SCALLOP_LOG(DEBUG, "parent keyword: %s  args[%d]: %s",
             parent->keyword(parent), nest, args[nest]);
 
     // Search through the parent command's sub-commands, but by starting
@@ -239,8 +401,8 @@ static void scallop_tab_completion(void * object, const char * buffer)
     linebytes->destroy(linebytes);
 
     if (!pmatches || pmatches->length(pmatches) == 0) { return; }
-    BLAMMO(DEBUG, "partial_matches length: %u  longest: %u",
-                  pmatches->length(pmatches), longest);
+    SCALLOP_LOG(DEBUG, "partial_matches length: %u  longest: %u",
+                       pmatches->length(pmatches), longest);
 
     // Need to duplicate the line again, but this time leave the copy
     // mostly intact except that we want to modify the potentially
@@ -271,8 +433,8 @@ static void scallop_tab_completion(void * object, const char * buffer)
         linebytes->append(linebytes, keyword, strlen(keyword));
         linebytes->append(linebytes, scallop_cmd_delim, 1);
 
-        BLAMMO(DEBUG, "Adding tab completion line: \'%s\'",
-                      linebytes->cstr(linebytes));
+        SCALLOP_LOG(DEBUG, "Adding tab completion line: \'%s\'",
+                           linebytes->cstr(linebytes));
 
         priv->console->add_tab_completion(priv->console,
                                           linebytes->cstr(linebytes));
@@ -291,7 +453,7 @@ static char * scallop_arg_hints(void * object,
                                 int * color,
                                 int * bold)
 {
-    BLAMMO(DEBUG, "buffer: \'%s\'", buffer);
+    SCALLOP_LOG(DEBUG, "buffer: \'%s\'", buffer);
 
     // Always get a handle on the singleton scallop
     OBJECT_PTR(, scallop, object, NULL);
@@ -332,11 +494,11 @@ static char * scallop_arg_hints(void * object,
         command = priv->commands->find_by_keyword(parent, args[nest]);
         if (!command)
         {
-            BLAMMO(DEBUG, "Command %s not found", args[nest]);
+            SCALLOP_LOG(DEBUG, "Command %s not found", args[nest]);
             break;
         }
 
-        BLAMMO(DEBUG, "Command %s found!", args[nest]);
+        SCALLOP_LOG(DEBUG, "Command %s found!", args[nest]);
         parent = command;
     }
 
@@ -347,7 +509,7 @@ static char * scallop_arg_hints(void * object,
     const char * arghints = parent->arghints(parent);
     if (!arghints)
     {
-        BLAMMO(DEBUG, "No arg hints to provide");
+        SCALLOP_LOG(DEBUG, "No arg hints to provide");
         return NULL;
     }
 
@@ -366,7 +528,7 @@ static char * scallop_arg_hints(void * object,
                                          scallop_cmd_comment,
                                          &hintc);
 
-    BLAMMO(DEBUG, "arghints: %s  hintc: %d  argc: %d  nest: %d",
+    SCALLOP_LOG(DEBUG, "arghints: %s  hintc: %d  argc: %d  nest: %d",
             parent->arghints(parent), hintc, argc, nest);
 
     // Only show hints for expected arguments that have not already been
@@ -378,10 +540,10 @@ static char * scallop_arg_hints(void * object,
     // provided (argc), and the nest level.
     hindex = argc - nest;
 
-    BLAMMO(DEBUG, "Un-coerced index is %d", hindex);
+    SCALLOP_LOG(DEBUG, "Un-coerced index is %d", hindex);
     if (hindex < 0 || hindex >= hintc)
     {
-        BLAMMO(DEBUG, "Invalid hint index");
+        SCALLOP_LOG(DEBUG, "Invalid hint index");
         return NULL;
     }
 
@@ -410,6 +572,11 @@ static void scallop_rebuild_prompt(scallop_t * scallop)
     OBJECT_PRIV(, scallop);
     scallop_construct_t * construct = NULL;
 
+    if (priv->batch)
+    {
+        return;
+    }
+
     priv->prompt->resize(priv->prompt, 0);
 
     // Start with prompt base
@@ -483,6 +650,41 @@ static scallop_t * scallop_create(console_t * console,
         return NULL;
     }
 
+    priv->assigned = scallop_map_pub.create();
+    if (!priv->assigned)
+    {
+        BLAMMO(FATAL, "scallop_map_pub.create() failed");
+        scallop->destroy(scallop);
+        return NULL;
+    }
+
+    // Create variable providers collection
+    priv->providers = collect_pub.create();
+    if (!priv->providers)
+    {
+        BLAMMO(FATAL, "collect_pub.create() failed");
+        scallop->destroy(scallop);
+        return NULL;
+    }
+
+    // Create list variables collection
+    priv->lists = collect_pub.create();
+    if (!priv->lists)
+    {
+        BLAMMO(FATAL, "collect_pub.create() failed");
+        scallop->destroy(scallop);
+        return NULL;
+    }
+
+    // Create map variables collection
+    priv->maps = collect_pub.create();
+    if (!priv->maps)
+    {
+        BLAMMO(FATAL, "collect_pub.create() failed");
+        scallop->destroy(scallop);
+        return NULL;
+    }
+
     // Create context stack.  Could likely have just passed NULL
     // for the copy function, since we never intend to copy the
     // context, but it might happen later when we get into
@@ -536,6 +738,15 @@ static void scallop_destroy(void * scallop_ptr)
 {
     OBJECT_PTR(, scallop, scallop_ptr, );
 
+    // Write out anything still buffered before the buffer goes away
+    scallop->buffer_output(scallop, false);
+
+    // Destroy the trace event recorder
+    if (priv->trace)
+    {
+        priv->trace->destroy(priv->trace);
+    }
+
     // Destroy all routines
     if (priv->routines)
     {
@@ -560,12 +771,36 @@ static void scallop_destroy(void * scallop_ptr)
         priv->constructs->destroy(priv->constructs);
     }
 
+    // Destroy map variables collection
+    if (priv->maps)
+    {
+        priv->maps->destroy(priv->maps);
+    }
+
+    // Destroy list variables collection
+    if (priv->lists)
+    {
+        priv->lists->destroy(priv->lists);
+    }
+
+    // Destroy variable providers collection
+    if (priv->providers)
+    {
+        priv->providers->destroy(priv->providers);
+    }
+
     // Destroy variables collection
     if (priv->variables)
     {
         priv->variables->destroy(priv->variables);
     }
 
+    if (priv->assigned)
+    {
+        priv->assigned->destroy(priv->assigned);
+    }
+
+    free(priv->cache_dir);
     OBJECT_FREE(, scallop);
 }
 
@@ -647,6 +882,81 @@ static void scallop_routine_remove(scallop_t * scallop,
     priv->routines->remove(priv->routines);
 }
 
+//------------------------------------------------------------------------|
+static scallop_list_t * scallop_list_by_name(scallop_t * scallop,
+                                             const char * name)
+{
+    OBJECT_PRIV(, scallop);
+    return (scallop_list_t *) priv->lists->get(priv->lists, name);
+}
+
+//------------------------------------------------------------------------|
+static scallop_list_t * scallop_list_insert(scallop_t * scallop,
+                                            const char * name)
+{
+    OBJECT_PRIV(, scallop);
+
+    scallop_list_t * list = scallop_list_pub.create();
+    if (!list)
+    {
+        BLAMMO(ERROR, "scallop_list_pub.create() failed");
+        return NULL;
+    }
+
+    // Replaces (and destroys) any existing list by the same name
+    priv->lists->set(priv->lists, name, list, NULL, scallop_list_pub.destroy);
+    return list;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_list_remove(scallop_t * scallop,
+                                const char * name)
+{
+    OBJECT_PRIV(, scallop);
+    priv->lists->remove(priv->lists, name);
+}
+
+//------------------------------------------------------------------------|
+static scallop_map_t * scallop_map_by_name(scallop_t * scallop,
+                                           const char * name)
+{
+    OBJECT_PRIV(, scallop);
+    return (scallop_map_t *) priv->maps->get(priv->maps, name);
+}
+
+//------------------------------------------------------------------------|
+static scallop_map_t * scallop_map_insert(scallop_t * scallop,
+                                          const char * name)
+{
+    OBJECT_PRIV(, scallop);
+
+    scallop_map_t * map = scallop_map_pub.create();
+    if (!map)
+    {
+        BLAMMO(ERROR, "scallop_map_pub.create() failed");
+        return NULL;
+    }
+
+    // Replaces (and destroys) any existing map by the same name
+    priv->maps->set(priv->maps, name, map, NULL, scallop_map_pub.destroy);
+    return map;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_map_remove(scallop_t * scallop,
+                               const char * name)
+{
+    OBJECT_PRIV(, scallop);
+    priv->maps->remove(priv->maps, name);
+}
+
+//------------------------------------------------------------------------|
+static inline void * scallop_routines(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    return priv->routines;
+}
+
 //------------------------------------------------------------------------|
 static void scallop_store_args(scallop_t * scallop, int argc, char ** args)
 {
@@ -708,396 +1018,1921 @@ static void scallop_store_args(scallop_t * scallop, int argc, char ** args)
 }
 
 //------------------------------------------------------------------------|
-static void scallop_assign_variable(scallop_t * scallop,
-                                    const char * varname,
-                                    const char * varvalue)
-{
-    OBJECT_PRIV(, scallop);
-    bytes_t * valuebytes = bytes_pub.create(varvalue,
-                                            strlen(varvalue));
-
-    priv->variables->set(priv->variables,
-                         varname,
-                         valuebytes,
-                         bytes_pub.copy,
-                         bytes_pub.destroy);
-}
-
-//------------------------------------------------------------------------|
-// Substitute all variable references in string with literal values
-static bool scallop_substitute_variables(scallop_t * scallop,
-                                         bytes_t * linebytes)
+// Find the innermost loop variable bound to a name, or NULL
+static scallop_binding_t * scallop_find_binding(scallop_priv_t * priv,
+                                                const char * name)
 {
-    OBJECT_PRIV(, scallop);
-    ssize_t offset_begin = 0;
-    ssize_t offset_end = 0;
-    bytes_t * varname = bytes_pub.create(NULL, 0);
-    bytes_t * varvalue = NULL;
+    size_t index = priv->nbindings;
 
-    // work through the entire raw line, replacing variable references
-    // "{variable_name}" with the string value of each variable.
-    while (offset_begin >= 0)
+    while (index > 0)
     {
-        offset_begin = linebytes->find_forward(linebytes,
-                                               offset_end,
-                                               scallop_var_begin,
-                                               strlen(scallop_var_begin));
-        if(offset_begin < 0)
+        index--;
+        if (!strcmp(priv->bindings[index].name, name))
         {
-            BLAMMO(DEBUG, "No further variable references found.  begin: %ld",
-                          offset_begin);
-            break;
+            return &priv->bindings[index];
         }
+    }
 
-        offset_end = linebytes->find_forward(linebytes,
-                                             offset_begin,
-                                             scallop_var_end,
-                                             strlen(scallop_var_end));
-        if(offset_end < 0)
-        {
-            BLAMMO(DEBUG, "No variable reference ending token found.  end: %ld",
-                          offset_end);
-            break;
-        }
+    return NULL;
+}
 
-        // Extract variable name out of line
-        varname->assign(varname, &linebytes->data(linebytes)[offset_begin + 1],
-                                 offset_end - offset_begin - 1);
-        BLAMMO(DEBUG, "varname: \'%s\'", varname->cstr(varname));
+//------------------------------------------------------------------------|
+// Assign a name bound by a loop, writing through to its counter, or to
+// the list item at its index.  A counter only takes a number.
+static bool scallop_assign_binding(scallop_priv_t * priv,
+                                   scallop_binding_t * binding,
+                                   const char * varvalue)
+{
+    scallop_list_t * list = NULL;
+    char * end = NULL;
+    long counter = 0;
 
-        // Get the variable referenced
-        varvalue = (bytes_t *) priv->variables->get(priv->variables,
-                                                    varname->cstr(varname));
-        if (!varvalue)
+    if (binding->list)
+    {
+        list = (scallop_list_t *) priv->lists->get(priv->lists, binding->list);
+        if (!list || !list->set(list, *binding->counter, varvalue))
         {
             priv->console->error(priv->console,
-                                 "variable \'%s\' not found",
-                                 varname->cstr(varname));
-            //continue;
-            varname->destroy(varname);
+                                 "can't assign \'%s\', list \'%s\' has no item %ld",
+                                 binding->name,
+                                 binding->list,
+                                 *binding->counter);
             return false;
         }
 
-        linebytes->remove(linebytes,
-                          offset_begin,
-                          offset_end - offset_begin + 1);
-        BLAMMO(DEBUG, "modified linebytes: %s", linebytes->cstr(linebytes));
+        return true;
+    }
 
-        linebytes->insert(linebytes,
-                          offset_begin,
-                          varvalue->data(varvalue),
-                          varvalue->size(varvalue));
-        BLAMMO(DEBUG, "modified linebytes: %s", linebytes->cstr(linebytes));
+    errno = 0;
+    counter = strtol(varvalue, &end, 0);
+    if (errno || end == varvalue || *end)
+    {
+        priv->console->error(priv->console,
+                             "can't assign \'%s\' to loop counter \'%s\'",
+                             varvalue,
+                             binding->name);
+        return false;
     }
 
-    varname->destroy(varname);
+    *binding->counter = counter;
     return true;
 }
 
 //------------------------------------------------------------------------|
-// Private helper function to set return value from last dispatch
-// should return the same value that is passed in, but sets the
-// special "%?" return value in the variable collection
-static int scallop_set_result(scallop_t * scallop, int result)
+static bool scallop_assign_variable(scallop_t * scallop,
+                                    const char * varname,
+                                    const char * varvalue)
 {
     OBJECT_PRIV(, scallop);
+    scallop_binding_t * binding = scallop_find_binding(priv, varname);
+    bytes_t * valuebytes = NULL;
 
-    bytes_t * varname = bytes_pub.print_create("%s%s",
-                                               scallop_arg_prefix,
-                                               scallop_var_result);
+    if (binding)
+    {
+        return scallop_assign_binding(priv, binding, varvalue);
+    }
 
-    bytes_t * varvalue = bytes_pub.print_create("%d", result);
+    // An existing variable takes the new value in place, so only a new
+    // one costs an allocation, or a place among the names assigned.
+    valuebytes = (bytes_t *) priv->variables->get(priv->variables, varname);
+    if (valuebytes)
+    {
+        valuebytes->assign(valuebytes, varvalue, strlen(varvalue));
+        return true;
+    }
 
+    valuebytes = bytes_pub.create(varvalue, strlen(varvalue));
     priv->variables->set(priv->variables,
-                         varname->cstr(varname),
-                         varvalue,
+                         varname,
+                         valuebytes,
                          bytes_pub.copy,
                          bytes_pub.destroy);
+    priv->assigned->set(priv->assigned, varname, "");
+    return true;
+}
 
-    varname->destroy(varname);
+//------------------------------------------------------------------------|
+static bool scallop_next_variable(scallop_t * scallop,
+                                  size_t * cursor,
+                                  const char ** varname,
+                                  const char ** varvalue)
+{
+    OBJECT_PRIV(, scallop);
+    bytes_t * value = NULL;
+    const char * unused = NULL;
 
-    return result;
+    while (priv->assigned->next(priv->assigned, cursor, varname, &unused))
+    {
+        value = (bytes_t *) priv->variables->get(priv->variables, *varname);
+        if (value)
+        {
+            *varvalue = value->cstr(value);
+            return true;
+        }
+    }
+
+    return false;
 }
 
 //------------------------------------------------------------------------|
-static long scallop_evaluate_condition(scallop_t * scallop,
-                                       const char * condition,
-                                       size_t size)
+static void scallop_provider_destroy(void * provider_ptr)
 {
-    console_t * console = scallop->console(scallop);
+    scallop_provider_t * provider = (scallop_provider_t *) provider_ptr;
 
-    // Make a fresh copy of the raw condition string every call
-    bytes_t * copy = bytes_pub.create(condition, size);
-    long result = 0;
+    if (provider->value)
+    {
+        provider->value->destroy(provider->value);
+    }
 
+    free(provider);
+}
 
-    // Perform substitution with latest values
-    if (!scallop_substitute_variables(scallop, copy))
+//------------------------------------------------------------------------|
+static bool scallop_provide_variable(scallop_t * scallop,
+                                     const char * name,
+                                     scallop_provider_f function,
+                                     void * object,
+                                     bool cache)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_provider_t * provider = NULL;
+
+    if (!name || !name[0] || !function)
     {
-        console->error(console, "variable substitution failed");
-        copy->destroy(copy);
-        scallop_set_result(scallop, ERROR_MARKER_DEC);
-        return 0;
+        BLAMMO(ERROR, "invalid provider parameters");
+        return false;
     }
 
-    // Check if the condition is an expression
-    if (!sparser_is_expr(copy->cstr(copy)))
+    provider = (scallop_provider_t *) malloc(sizeof(scallop_provider_t));
+    if (!provider)
     {
-        console->error(console,
-                       "condition \'%s\' is not an expression",
-                       copy->cstr(copy));
-        copy->destroy(copy);
-        scallop_set_result(scallop, ERROR_MARKER_DEC);
-        return 0;
+        BLAMMO(FATAL, "malloc(sizeof(scallop_provider_t)) failed");
+        return false;
     }
 
-    // Check if the expression is valid
-    result = sparser_evaluate(console->error, console, copy->cstr(copy));
-    if (result == SPARSER_INVALID_EXPRESSION)
+    memzero(provider, sizeof(scallop_provider_t));
+    provider->provider = function;
+    provider->object = object;
+    provider->cache = cache;
+    provider->value = bytes_pub.create(NULL, 0);
+    if (!provider->value)
     {
-        console->error(console,
-                       "condition \'%s\' is an invalid expression",
+        BLAMMO(FATAL, "bytes_pub.create() failed");
+        scallop_provider_destroy(provider);
+        return false;
+    }
+
+    if (!priv->providers->get(priv->providers, name))
+    {
+        priv->nproviders++;
+    }
+
+    priv->providers->set(priv->providers,
+                         name,
+                         provider,
+                         NULL,
+                         scallop_provider_destroy);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_unprovide_variable(scallop_t * scallop, const char * name)
+{
+    OBJECT_PRIV(, scallop);
+
+    if (!priv->providers->get(priv->providers, name))
+    {
+        return false;
+    }
+
+    priv->providers->remove(priv->providers, name);
+    priv->nproviders--;
+    return true;
+}
+
+
+//------------------------------------------------------------------------|
+static bool scallop_bind(scallop_t * scallop,
+                         const char * name,
+                         long * counter,
+                         const char * list)
+{
+    OBJECT_PRIV(, scallop);
+
+    if (priv->nbindings >= SCALLOP_MAX_RECURS)
+    {
+        return false;
+    }
+
+    priv->bindings[priv->nbindings].name = name;
+    priv->bindings[priv->nbindings].counter = counter;
+    priv->bindings[priv->nbindings].list = list;
+    priv->nbindings++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_bind_counter(scallop_t * scallop,
+                                 const char * name,
+                                 long * counter)
+{
+    return scallop_bind(scallop, name, counter, NULL);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_bind_item(scallop_t * scallop,
+                              const char * name,
+                              const char * list,
+                              long * index)
+{
+    return scallop_bind(scallop, name, index, list);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_unbind(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+
+    if (priv->nbindings > 0)
+    {
+        priv->nbindings--;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Get a provided variable's value, computing it unless it's cached and
+// no line has been dispatched since it was computed.
+static const char * scallop_resolve_provider(scallop_priv_t * priv,
+                                             const char * name,
+                                             scallop_provider_t * provider)
+{
+    if (provider->cache && provider->computed &&
+            provider->dispatches == priv->dispatches)
+    {
+        return provider->value->cstr(provider->value);
+    }
+
+    provider->value->assign(provider->value, NULL, 0);
+    provider->computed = provider->provider(provider->object,
+                                            name,
+                                            provider->value);
+    provider->dispatches = priv->dispatches;
+    return provider->computed ? provider->value->cstr(provider->value) : NULL;
+}
+
+//------------------------------------------------------------------------|
+// Resolve a scalar reference name to its value: either a bound loop
+// variable, innermost first, a provided variable, or a stored variable.
+// Numbers are formatted into the caller's buffer.  Returns NULL if
+// nothing goes by that name.
+static const char * scallop_resolve_scalar(scallop_priv_t * priv,
+                                           const char * name,
+                                           char * number,
+                                           size_t size)
+{
+    scallop_binding_t * binding = scallop_find_binding(priv, name);
+    scallop_provider_t * provider = NULL;
+    scallop_list_t * list = NULL;
+    bytes_t * value = NULL;
+
+    if (priv->nproviders > 0 && !binding)
+    {
+        provider = (scallop_provider_t *)
+                priv->providers->get(priv->providers, name);
+    }
+
+    if (provider)
+    {
+        return scallop_resolve_provider(priv, name, provider);
+    }
+    else if (binding && binding->list)
+    {
+        list = (scallop_list_t *) priv->lists->get(priv->lists, binding->list);
+        return list ? list->get(list, *binding->counter) : NULL;
+    }
+    else if (binding)
+    {
+        snprintf(number, size, "%ld", *binding->counter);
+        return number;
+    }
+
+    value = (bytes_t *) priv->variables->get(priv->variables, name);
+    return value ? value->cstr(value) : NULL;
+}
+
+//------------------------------------------------------------------------|
+// Resolve the text of a reference, without braces, to its value.  This
+// is either a scalar name, a map value as 'name.key', or a list item as
+// 'name[index]' where index is an integer or the name of a scalar holding
+// one.  scratch is used for splitting the reference apart.  Reports
+// errors and returns NULL if the reference cannot be resolved.
+static const char * scallop_resolve(scallop_priv_t * priv,
+                                    bytes_t * reference,
+                                    bytes_t * scratch,
+                                    char * number,
+                                    size_t size)
+{
+    const char * name = reference->cstr(reference);
+    size_t length = reference->size(reference);
+    const char * bracket = NULL;
+    const char * dot = NULL;
+    const char * value = NULL;
+    scallop_list_t * list = NULL;
+    scallop_map_t * map = NULL;
+    char * end = NULL;
+    long index = 0;
+
+    bracket = (length > 0 && name[length - 1] == ']') ?
+              memchr(name, '[', length) : NULL;
+    if (!bracket)
+    {
+        value = scallop_resolve_scalar(priv, name, number, size);
+        if (value)
+        {
+            return value;
+        }
+
+        // Scalars may have dots in their names, so maps come second.  The
+        // key is everything after the first dot.
+        dot = memchr(name, '.', length);
+        if (dot)
+        {
+            scratch->assign(scratch, name, dot - name);
+            map = (scallop_map_t *) priv->maps->get(priv->maps,
+                                                    scratch->cstr(scratch));
+            value = map ? map->get(map, dot + 1) : NULL;
+            if (map && !value)
+            {
+                priv->console->error(priv->console,
+                                     "key \'%s\' not found in map \'%s\'",
+                                     dot + 1,
+                                     scratch->cstr(scratch));
+                return NULL;
+            }
+        }
+
+        if (!value)
+        {
+            priv->console->error(priv->console,
+                                 "variable \'%s\' not found",
+                                 name);
+        }
+
+        return value;
+    }
+
+    // Literal index, or else the name of something holding one
+    index = strtol(bracket + 1, &end, 0);
+    if (end == bracket + 1 || end != &name[length - 1])
+    {
+        scratch->assign(scratch, bracket + 1, &name[length - 1] - bracket - 1);
+        value = scallop_resolve_scalar(priv,
+                                       scratch->cstr(scratch),
+                                       number,
+                                       size);
+        index = value ? strtol(value, &end, 0) : 0;
+        if (!value || end == value || *end != '\0')
+        {
+            priv->console->error(priv->console,
+                                 "invalid index in \'%s\'",
+                                 name);
+            return NULL;
+        }
+    }
+
+    scratch->assign(scratch, name, bracket - name);
+    list = (scallop_list_t *) priv->lists->get(priv->lists,
+                                               scratch->cstr(scratch));
+    if (!list)
+    {
+        priv->console->error(priv->console,
+                             "list \'%s\' not found",
+                             scratch->cstr(scratch));
+        return NULL;
+    }
+
+    value = list->get(list, index);
+    if (!value)
+    {
+        priv->console->error(priv->console,
+                             "index %ld out of range for list \'%s\'",
+                             index,
+                             scratch->cstr(scratch));
+    }
+
+    return value;
+}
+
+//------------------------------------------------------------------------|
+// Done with substitution scratch buffers: hand them back to the batch
+// they were borrowed from, if any, or destroy them.
+static void scallop_release_scratch(scallop_arena_t * arena,
+                                    bytes_t * varname,
+                                    bytes_t * scratch)
+{
+    if (arena)
+    {
+        arena->substituting = false;
+        return;
+    }
+
+    scratch->destroy(scratch);
+    varname->destroy(varname);
+}
+
+//------------------------------------------------------------------------|
+// Substitute all variable references in string with literal values
+static bool scallop_substitute_variables(scallop_t * scallop,
+                                         bytes_t * linebytes)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_arena_t * arena = priv->arena;
+    ssize_t offset_begin = 0;
+    ssize_t offset_end = 0;
+    bytes_t * varname = NULL;
+    bytes_t * scratch = NULL;
+    const char * varvalue = NULL;
+    size_t length = 0;
+    char number[24];
+
+    // Borrow the batch's buffers, unless already substituting with them
+    if (arena && !arena->substituting)
+    {
+        arena->substituting = true;
+        varname = arena->varname;
+        scratch = arena->value;
+    }
+    else
+    {
+        arena = NULL;
+        varname = bytes_pub.create(NULL, 0);
+        scratch = bytes_pub.create(NULL, 0);
+    }
+
+    // work through the entire raw line, replacing variable references
+    // "{variable_name}" with the string value of each variable.
+    while (offset_begin >= 0)
+    {
+        offset_begin = linebytes->find_forward(linebytes,
+                                               offset_end,
+                                               scallop_var_begin,
+                                               strlen(scallop_var_begin));
+        if(offset_begin < 0)
+        {
+            SCALLOP_LOG(DEBUG, "No further variable references found.  begin: %ld",
+                               offset_begin);
+            break;
+        }
+
+        offset_end = linebytes->find_forward(linebytes,
+                                             offset_begin,
+                                             scallop_var_end,
+                                             strlen(scallop_var_end));
+        if(offset_end < 0)
+        {
+            SCALLOP_LOG(DEBUG, "No variable reference ending token found.  end: %ld",
+                               offset_end);
+            break;
+        }
+
+        // Extract variable name out of line
+        varname->assign(varname, &linebytes->data(linebytes)[offset_begin + 1],
+                                 offset_end - offset_begin - 1);
+        SCALLOP_LOG(DEBUG, "varname: \'%s\'", varname->cstr(varname));
+
+        // Get the value referenced
+        varvalue = scallop_resolve(priv,
+                                   varname,
+                                   scratch,
+                                   number,
+                                   sizeof(number));
+        if (!varvalue)
+        {
+            //continue;
+            scallop_release_scratch(arena, varname, scratch);
+            return false;
+        }
+        length = strlen(varvalue);
+
+        linebytes->remove(linebytes,
+                          offset_begin,
+                          offset_end - offset_begin + 1);
+        SCALLOP_LOG(DEBUG, "modified linebytes: %s", linebytes->cstr(linebytes));
+
+        linebytes->insert(linebytes,
+                          offset_begin,
+                          varvalue,
+                          length);
+        SCALLOP_LOG(DEBUG, "modified linebytes: %s", linebytes->cstr(linebytes));
+
+        // Resume searching just after the inserted value.  The old end
+        // offset is stale and may skip over a following reference
+        // whenever the value is shorter than its reference.
+        offset_end = offset_begin + length;
+    }
+
+    scallop_release_scratch(arena, varname, scratch);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Private helper function to set return value from last dispatch
+// should return the same value that is passed in, but sets the
+// special "%?" return value in the variable collection
+static int scallop_set_result(scallop_t * scallop, int result)
+{
+    OBJECT_PRIV(, scallop);
+
+    bytes_t * varname = bytes_pub.print_create("%s%s",
+                                               scallop_arg_prefix,
+                                               scallop_var_result);
+
+    bytes_t * varvalue = bytes_pub.print_create("%d", result);
+
+    priv->variables->set(priv->variables,
+                         varname->cstr(varname),
+                         varvalue,
+                         bytes_pub.copy,
+                         bytes_pub.destroy);
+
+    varname->destroy(varname);
+
+    priv->result = result;
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_substitute(scallop_t * scallop, void * text)
+{
+    return scallop_substitute_variables(scallop, (bytes_t *) text);
+}
+
+//------------------------------------------------------------------------|
+static long scallop_evaluate_condition_untraced(scallop_t * scallop,
+                                                const char * condition,
+                                                size_t size)
+{
+    console_t * console = scallop->console(scallop);
+
+    // Make a fresh copy of the raw condition string every call
+    bytes_t * copy = bytes_pub.create(condition, size);
+    long result = 0;
+
+
+    // Perform substitution with latest values
+    if (!scallop_substitute_variables(scallop, copy))
+    {
+        console->error(console, "variable substitution failed");
+        copy->destroy(copy);
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return 0;
+    }
+
+    // Check if the condition is an expression
+    if (!sparser_is_expr(copy->cstr(copy)))
+    {
+        console->error(console,
+                       "condition \'%s\' is not an expression",
+                       copy->cstr(copy));
+        copy->destroy(copy);
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return 0;
+    }
+
+    // Check if the expression is valid
+    result = sparser_evaluate(console->error, console, copy->cstr(copy));
+    if (result == SPARSER_INVALID_EXPRESSION)
+    {
+        console->error(console,
+                       "condition \'%s\' is an invalid expression",
                        copy->cstr(copy));
         scallop_set_result(scallop, ERROR_MARKER_DEC);
         return 0;
     }
 
-    copy->destroy(copy);
-    return result;
+    copy->destroy(copy);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static long scallop_evaluate_condition(scallop_t * scallop,
+                                       const char * condition,
+                                       size_t size)
+{
+    OBJECT_PRIV(, scallop);
+    long result = 0;
+
+    if (!priv->tracing)
+    {
+        return scallop_evaluate_condition_untraced(scallop, condition, size);
+    }
+
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "evaluate", condition, size);
+    result = scallop_evaluate_condition_untraced(scallop, condition, size);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "evaluate", NULL, 0);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_evaluate_value_untraced(scallop_t * scallop,
+                                            const char * text,
+                                            size_t size,
+                                            long * value)
+{
+    console_t * console = scallop->console(scallop);
+    bytes_t * copy = bytes_pub.create(text, size);
+    char * end = NULL;
+    bool success = true;
+
+    // Perform substitution with latest values
+    if (!scallop_substitute_variables(scallop, copy))
+    {
+        copy->destroy(copy);
+        return false;
+    }
+
+    if (sparser_is_expr(copy->cstr(copy)))
+    {
+        *value = sparser_evaluate(console->error, console, copy->cstr(copy));
+        success = (*value != SPARSER_INVALID_EXPRESSION);
+    }
+    else
+    {
+        *value = strtol(copy->cstr(copy), &end, 0);
+        success = (end != copy->cstr(copy) && *end == '\0');
+    }
+
+    if (!success)
+    {
+        console->error(console,
+                       "\'%s\' is not a numeric value",
+                       copy->cstr(copy));
+    }
+
+    copy->destroy(copy);
+    return success;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_evaluate_value(scallop_t * scallop,
+                                   const char * text,
+                                   size_t size,
+                                   long * value)
+{
+    OBJECT_PRIV(, scallop);
+    bool success = false;
+
+    if (!priv->tracing)
+    {
+        return scallop_evaluate_value_untraced(scallop, text, size, value);
+    }
+
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "evaluate", text, size);
+    success = scallop_evaluate_value_untraced(scallop, text, size, value);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "evaluate", NULL, 0);
+    return success;
+}
+
+//------------------------------------------------------------------------|
+// Find the first of an operator character on a line, outside of any
+// quotes, parentheses or braces and ahead of any comment.  A doubled pipe
+// is logical 'or', and skipped.  Returns NULL if there is none.
+static const char * scallop_find_operator(const char * line, char op)
+{
+    const char * c = NULL;
+    size_t nesting = 0;
+    bool quoted = false;
+
+    for (c = line; *c; c++)
+    {
+        if (quoted)
+        {
+            quoted = (*c != '"');
+        }
+        else if (*c == '"')
+        {
+            quoted = true;
+        }
+        else if (*c == '(' || *c == '{')
+        {
+            nesting++;
+        }
+        else if (*c == ')' || *c == '}')
+        {
+            nesting -= (nesting > 0);
+        }
+        else if (nesting > 0)
+        {
+            continue;
+        }
+        else if (*c == scallop_cmd_comment[0])
+        {
+            break;
+        }
+        else if (*c == op)
+        {
+            if (op != scallop_pipe || c[1] != scallop_pipe)
+            {
+                return c;
+            }
+
+            // Skip over logical 'or'
+            c++;
+        }
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------|
+// Each command of a pipeline, or one redirected, is dispatched as a line
+// of its own
+static void scallop_dispatch_line(scallop_t * scallop, const char * line);
+
+//------------------------------------------------------------------------|
+// Run each command of a pipeline in turn.  The console output of all but
+// the last is captured in a stream rather than printed, and that stream
+// is the input of the next command.  The first command gets the input of
+// the pipeline itself, if any, as when a routine run from one pipeline
+// runs another.  The result is that of the last command.
+static void scallop_dispatch_pipeline(scallop_t * scallop, const char * line)
+{
+    OBJECT_PRIV(, scallop);
+    console_t * console = priv->console;
+    FILE * outputf = console->get_outputf(console);
+    scallop_stream_t * pipeline_input = priv->input;
+    scallop_stream_t * input = pipeline_input;
+    scallop_stream_t * output = NULL;
+    char * stages = strdup(line);
+    char * stage = stages;
+    char * pipe = NULL;
+    size_t nstages = 0;
+    size_t index = 0;
+
+    if (!stages)
+    {
+        BLAMMO(FATAL, "strdup() failed");
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    // Split all the commands out in place up front, so that nothing runs
+    // if any of them is missing
+    do
+    {
+        pipe = (char *) scallop_find_operator(stage, scallop_pipe);
+        if (pipe)
+        {
+            *pipe = '\0';
+        }
+
+        stage += strspn(stage, scallop_cmd_delim);
+        if (!*stage)
+        {
+            console->error(console, "missing command in pipeline");
+            free(stages);
+            scallop_set_result(scallop, ERROR_MARKER_DEC);
+            return;
+        }
+
+        nstages++;
+        stage = pipe ? pipe + 1 : stage;
+    }
+    while (pipe);
+
+    for (stage = stages, index = 0; index < nstages; index++)
+    {
+        if (index + 1 < nstages)
+        {
+            output = scallop_stream_pub.create();
+            if (!output)
+            {
+                scallop_set_result(scallop, ERROR_MARKER_DEC);
+                break;
+            }
+
+            console->set_outputf(console, output->writer(output));
+        }
+
+        priv->input = input;
+        priv->stage = true;
+        scallop_dispatch_line(scallop, stage);
+        priv->stage = false;
+
+        console->set_outputf(console, outputf);
+        if (input != pipeline_input)
+        {
+            input->destroy(input);
+        }
+
+        input = output;
+        output = NULL;
+        stage += strlen(stage) + 1;
+    }
+
+    if (input && input != pipeline_input)
+    {
+        input->destroy(input);
+    }
+
+    priv->input = pipeline_input;
+    free(stages);
+}
+
+//------------------------------------------------------------------------|
+// Open the file named by the text after a redirection operator, which may
+// include variable references, for writing through a large buffer of its
+// own.  Returns NULL, having reported why, if it can't be opened.
+static FILE * scallop_open_sink(scallop_t * scallop,
+                                const char * text,
+                                bool append,
+                                char ** buffer)
+{
+    OBJECT_PRIV(, scallop);
+    bytes_t * target = bytes_pub.create(text, strlen(text));
+    char ** args = NULL;
+    size_t argc = 0;
+    FILE * sink = NULL;
+
+    if (!scallop_substitute_variables(scallop, target))
+    {
+        target->destroy(target);
+        return NULL;
+    }
+
+    args = target->tokenizer(target,
+                             true,
+                             scallop_encaps_pairs,
+                             scallop_cmd_delim,
+                             scallop_cmd_comment,
+                             &argc);
+    if (argc != 1)
+    {
+        priv->console->error(priv->console,
+                             "expected one file name after \'%s\'",
+                             append ? ">>" : ">");
+        target->destroy(target);
+        return NULL;
+    }
+
+    sink = fopen(args[0], append ? "a" : "w");
+    if (!sink)
+    {
+        priv->console->error(priv->console,
+                             "could not open %s for writing",
+                             args[0]);
+        target->destroy(target);
+        return NULL;
+    }
+
+    // Fall back to the file's own buffering if there's no memory for more
+    *buffer = (char *) malloc(SCALLOP_OUTPUT_BUFFER);
+    if (*buffer)
+    {
+        setvbuf(sink, *buffer, _IOFBF, SCALLOP_OUTPUT_BUFFER);
+    }
+
+    target->destroy(target);
+    return sink;
+}
+
+//------------------------------------------------------------------------|
+// Run a command, or a pipeline, with its console output written to a file
+// instead.  The output goes out in a few big writes, apart from anything
+// printed at the prompt, and the console is put back as it was after.
+static void scallop_dispatch_redirect(scallop_t * scallop,
+                                      const char * line,
+                                      const char * redirect)
+{
+    OBJECT_PRIV(, scallop);
+    console_t * console = priv->console;
+    FILE * outputf = console->get_outputf(console);
+    bool append = (redirect[1] == scallop_redirect);
+    bytes_t * command = bytes_pub.create(line, redirect - line);
+    const char * text = command->cstr(command);
+    char * buffer = NULL;
+    FILE * sink = NULL;
+
+    if (!text[strspn(text, scallop_cmd_delim)])
+    {
+        console->error(console,
+                       "missing command before \'%s\'",
+                       append ? ">>" : ">");
+        command->destroy(command);
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    sink = scallop_open_sink(scallop, redirect + 1 + append, append, &buffer);
+    if (!sink)
+    {
+        command->destroy(command);
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    console->set_outputf(console, sink);
+    if (scallop_find_operator(text, scallop_pipe))
+    {
+        scallop_dispatch_pipeline(scallop, text);
+    }
+    else
+    {
+        priv->stage = true;
+        scallop_dispatch_line(scallop, text);
+        priv->stage = false;
+    }
+
+    console->set_outputf(console, outputf);
+    if (fclose(sink) != 0)
+    {
+        console->error(console, "writing redirected output failed");
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    free(buffer);
+    command->destroy(command);
+}
+
+//------------------------------------------------------------------------|
+// Look up a top-level command by keyword, remembering it while in a batch
+static scallop_cmd_t * scallop_find_command(scallop_priv_t * priv,
+                                            const char * keyword)
+{
+    scallop_arena_t * arena = priv->arena;
+    scallop_resolved_t * resolved = NULL;
+    scallop_cmd_t * command = NULL;
+    size_t hash = 0;
+    size_t size = 0;
+
+    if (!arena)
+    {
+        return priv->commands->find_by_keyword(priv->commands, keyword);
+    }
+
+    // Forget everything once anything has been registered or removed
+    if (arena->changes != scallop_cmd_pub.changes())
+    {
+        memzero(arena->resolved, sizeof(arena->resolved));
+        arena->changes = scallop_cmd_pub.changes();
+    }
+
+    size = strlen(keyword);
+    hash = scallop_hash_bytes(keyword, size);
+
+    resolved = &arena->resolved[hash % SCALLOP_RESOLVED_SIZE];
+    if (resolved->command && strcmp(resolved->keyword, keyword) == 0)
+    {
+        return resolved->command;
+    }
+
+    command = priv->commands->find_by_keyword(priv->commands, keyword);
+    if (command && size <= SCALLOP_MAX_KEYWORD)
+    {
+        memcpy(resolved->keyword, keyword, size + 1);
+        resolved->command = command;
+    }
+
+    return command;
+}
+
+//------------------------------------------------------------------------|
+// Done with a line's copy: keep it for the next if it belongs to a batch
+static inline void scallop_release_line(scallop_priv_t * priv,
+                                        bytes_t * linebytes)
+{
+    if (!priv->arena || linebytes != priv->arena->line)
+    {
+        linebytes->destroy(linebytes);
+    }
+}
+
+//------------------------------------------------------------------------|
+// Need to know the command to be executed AND have the unaltered
+// line SIMULTANEOUSLY because the command->is_construct needs to be
+// known in order to disposition the RAW LINE.
+// NOTE: If and only if the line is to be tokenized & executed, should
+// it have variable substitution/evaluation performed on it.  I.E. do
+// not store mangled lines in constructs that have not yet been executed!
+// TODO: In the rare case where a line is dispatched directly from
+// the application's command-line (piped from stdin or given an option)
+// it's conceivable that extra unparsed argc/argv given to main() could
+// be overflowed into 'routine' style argument substitution, in addition
+// to variable-sustitution. -- TBD at a later time.
+// This would require a call to scallop_store_args() from main().
+//------------------------------------------------------------------------|
+// TODO: CLEAN UP THIS MESS:
+// if in the middle of defining a routine, while loop,
+// or other user-registered language construct, then
+// call that construct's line handler function rather
+// than executing the line directly. AND if and only
+// if the command itself is not a construct keyword.
+// TODO: TEST THIS WITH NESTED ROUTINE DEFINITIONS
+static void scallop_dispatch_line(scallop_t * scallop, const char * line)
+{
+    // Guard block NULL line ptr, or trivially empty line
+    if (!line || !line[0])
+    {
+        SCALLOP_LOG(VERBOSE, "Ignoring NULL/empty line");
+        // Don't update stored result for empty lines
+        return;
+    }
+
+    OBJECT_PRIV(, scallop);
+    SCALLOP_LOG(VERBOSE, "priv: %p depth: %u line: %s",
+                         priv, priv->depth, line);
+
+    // Whether this line is one command of a pipeline being run
+    bool stage = priv->stage;
+    priv->stage = false;
+
+    // A request left over from the previous top-level line had nothing
+    // to consume it, I.E. 'break' inside an 'if' typed at the prompt.
+    if (priv->depth == 0)
+    {
+        priv->unwind = SCALLOP_UNWIND_NONE;
+    }
+
+    // Limit recursion depth here
+    priv->depth++;
+    if (priv->depth > SCALLOP_MAX_RECURS)
+    {
+        priv->console->error(priv->console,
+                             "maximum recursion depth %u reached",
+                             SCALLOP_MAX_RECURS);
+        priv->depth--;
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    // Lines stored in a declaration are left whole, so that pipelines and
+    // redirection in them are only taken apart when they are run.
+    if (!stage && priv->constructs->empty(priv->constructs))
+    {
+        const char * redirect = scallop_find_operator(line, scallop_redirect);
+        if (redirect)
+        {
+            scallop_dispatch_redirect(scallop, line, redirect);
+            priv->depth--;
+            return;
+        }
+
+        if (scallop_find_operator(line, scallop_pipe))
+        {
+            scallop_dispatch_pipeline(scallop, line);
+            priv->depth--;
+            return;
+        }
+    }
+
+    // Make an initial copy of the line mainly because we need
+    // to lookup the command that is being specified.  NOTE:
+    // variables as commands are not supported!
+    bytes_t * linebytes = NULL;
+    if (priv->arena && priv->depth == 1)
+    {
+        linebytes = priv->arena->line;
+        linebytes->assign(linebytes, line, strlen(line));
+    }
+    else
+    {
+        linebytes = bytes_pub.create(line, strlen(line));
+    }
+    size_t argc = 0;
+    char ** args = linebytes->tokenizer(linebytes,
+                                        true,
+                                        scallop_encaps_pairs,
+                                        scallop_cmd_delim,
+                                        scallop_cmd_comment,
+                                        &argc);
+
+    // Ignore empty input
+    if (argc == 0)
+    {
+        SCALLOP_LOG(VERBOSE, "Ignoring empty tokenized line");
+        scallop_release_line(priv, linebytes);
+        priv->depth--;
+        // Don't update stored result for empty lines
+        return;
+    }
+
+    // Try to find the command being invoked
+    scallop_cmd_t * command = scallop_find_command(priv, args[0]);
+    if (!command)
+    {
+        priv->console->error(priv->console,
+                             "unknown command \'%s\'.  try \'help\'",
+                             args[0]);
+
+        scallop_release_line(priv, linebytes);
+        priv->depth--;
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    // A construct's body would only be stored, with no output to capture
+    if (stage && command->is_construct(command))
+    {
+        priv->console->error(priv->console,
+                             "output of \'%s\' can't be piped or redirected",
+                             args[0]);
+
+        scallop_release_line(priv, linebytes);
+        priv->depth--;
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    // The bottom item on the language stack is the most important
+    // construct declaration that is actively being defined, rather
+    // than executed.  When things are executed, the whole context
+    // becomes unpacked and flattened one construct at a time.
+    scallop_construct_t * declaration = (scallop_construct_t *)
+            priv->constructs->first(priv->constructs);
+
+    // Check if the command is a construct that is about to pop the
+    // last item on the construct stack, meaning this is about to be
+    // the end of this multi-line construct declaration!
+    bool is_end_of_declaration = (command->is_construct_pop(command) &&
+            priv->constructs->length(priv->constructs) == 1);
+
+    // Check if the command is a declaration modifier like 'else' or
+    // 'private' or 'public'.. something that marks a different
+    // section of the declaration.
+    bool is_declaration_modifier = (command->is_construct_modifier(command) &&
+            priv->constructs->length(priv->constructs) == 1);
+
+    // This should not happen, but check anyway just to eliminate
+    // it from the truth table.  'end' without matching 'routine/while/if'?
+    if (is_end_of_declaration && !declaration)
+    {
+        priv->console->error(priv->console,
+                             "pop command \'%s\' without construct declaration!",
+                             args[0]);
+
+        scallop_release_line(priv, linebytes);
+        priv->depth--;
+        scallop_set_result(scallop, ERROR_MARKER_DEC);
+        return;
+    }
+
+    // The truth table here gets complicated
+    // TODO: Transfer TT notes to here.
+    int result = 0;
+//    bool call_linefunc = declaration && declaration->linefunc &&
+//                         !is_end_of_declaration;
+    bool call_linefunc = declaration && declaration->linefunc &&
+                         !is_end_of_declaration && !is_declaration_modifier;
+
+    if (call_linefunc)
+    {
+        // Always add the raw line to the active declaration
+        result = declaration->linefunc(declaration->context,
+                                       declaration->object,
+                                       line);
+    }
+
+    if (command->is_construct(command) || !declaration)
+    {
+        // Need to make another copy of the line now in execution
+        // so that variable substitution can occur.
+        linebytes->assign(linebytes, line, strlen(line));
+
+        // Preprocessor-like variable substitution needs to happen
+        // before calling tokenize, to allow for supporting spaces
+        // in variables, multiple variables inside arguments, and
+        // complex expression evaluation.
+        // UPDATE 3/14/2024 - suspend substitution when linefunc was called.
+        // variables might not yet be defined!
+        // ALSO: DO NOT EVER substitute for constructs.  This would
+        // cause breakage when executing (ex:) while loops inside routine
+        // because the expression gets prematurely evaluated.
+        if (!call_linefunc && !command->is_construct(command) &&
+                !scallop_substitute_variables(scallop, linebytes))
+        {
+            scallop_release_line(priv, linebytes);
+            priv->depth--;
+            scallop_set_result(scallop, ERROR_MARKER_DEC);
+            return;
+        }
+
+        // When a construct command line is being added to a declaration
+        // (of another construct), it is only executed here to track
+        // nesting levels, so it's effectively a dry run.  mark it so.
+        if (call_linefunc && command->is_construct(command))
+        {
+            command->set_attributes(command, SCALLOP_CMD_ATTR_DRY_RUN);
+        }
+
+        // Re-tokenize now that substitution has occurred.
+        // Assume this copy is going to be OK, since it's been mostly checked already
+        argc = 0;
+        args = linebytes->tokenizer(linebytes,
+                                    true,
+                                    scallop_encaps_pairs,
+                                    scallop_cmd_delim,
+                                    scallop_cmd_comment,
+                                    &argc);
+
+        // Execute the command: calls handler with command, context, and arguments
+        scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                            "exec", args[0], SIZE_MAX);
+        result = command->exec(command, argc, args);
+        scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                            "exec", NULL, 0);
+        // It is the responsibility of the command handler to
+        // clear the dry run bit if it should
+    }
+
+    scallop_release_line(priv, linebytes);
+    priv->depth--;
+    scallop_set_result(scallop, result);
 }
 
 //------------------------------------------------------------------------|
-// Need to know the command to be executed AND have the unaltered
-// line SIMULTANEOUSLY because the command->is_construct needs to be
-// known in order to disposition the RAW LINE.
-// NOTE: If and only if the line is to be tokenized & executed, should
-// it have variable substitution/evaluation performed on it.  I.E. do
-// not store mangled lines in constructs that have not yet been executed!
-// TODO: In the rare case where a line is dispatched directly from
-// the application's command-line (piped from stdin or given an option)
-// it's conceivable that extra unparsed argc/argv given to main() could
-// be overflowed into 'routine' style argument substitution, in addition
-// to variable-sustitution. -- TBD at a later time.
-// This would require a call to scallop_store_args() from main().
-//------------------------------------------------------------------------|
-// TODO: CLEAN UP THIS MESS:
-// if in the middle of defining a routine, while loop,
-// or other user-registered language construct, then
-// call that construct's line handler function rather
-// than executing the line directly. AND if and only
-// if the command itself is not a construct keyword.
-// TODO: TEST THIS WITH NESTED ROUTINE DEFINITIONS
 static void scallop_dispatch(scallop_t * scallop, const char * line)
 {
-    // Guard block NULL line ptr, or trivially empty line
-    if (!line || !line[0])
+    OBJECT_PRIV(, scallop);
+
+    priv->dispatches++;
+    if (!priv->tracing)
     {
-        BLAMMO(VERBOSE, "Ignoring NULL/empty line");
-        // Don't update stored result for empty lines
+        scallop_dispatch_line(scallop, line);
         return;
     }
 
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "dispatch", line, SIZE_MAX);
+    scallop_dispatch_line(scallop, line);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "dispatch", NULL, 0);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_arena_destroy(scallop_arena_t * arena)
+{
+    if (arena->line)
+    {
+        arena->line->destroy(arena->line);
+    }
+
+    if (arena->varname)
+    {
+        arena->varname->destroy(arena->varname);
+    }
+
+    if (arena->value)
+    {
+        arena->value->destroy(arena->value);
+    }
+
+    free(arena);
+}
+
+//------------------------------------------------------------------------|
+static scallop_arena_t * scallop_arena_create()
+{
+    scallop_arena_t * arena = (scallop_arena_t *)
+            malloc(sizeof(scallop_arena_t));
+
+    if (!arena)
+    {
+        BLAMMO(FATAL, "malloc(sizeof(scallop_arena_t)) failed");
+        return NULL;
+    }
+
+    memzero(arena, sizeof(scallop_arena_t));
+    arena->line = bytes_pub.create(NULL, 0);
+    arena->varname = bytes_pub.create(NULL, 0);
+    arena->value = bytes_pub.create(NULL, 0);
+    if (!arena->line || !arena->varname || !arena->value)
+    {
+        BLAMMO(FATAL, "bytes_pub.create() failed");
+        scallop_arena_destroy(arena);
+        return NULL;
+    }
+
+    arena->changes = scallop_cmd_pub.changes();
+    return arena;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_dispatch_batch(scallop_t * scallop,
+                                     const char * const * lines,
+                                     size_t count,
+                                     int * results)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_arena_t * arena = NULL;
+    size_t index = 0;
+
+    // A batch within a batch just carries on with the one already going.
+    // Without the memory for one, lines are dispatched as usual.
+    if (!priv->arena)
+    {
+        arena = scallop_arena_create();
+        priv->arena = arena;
+    }
+
+    for (index = 0; index < count && !priv->quit; index++)
+    {
+        scallop_dispatch(scallop, lines[index]);
+        if (results)
+        {
+            results[index] = priv->result;
+        }
+    }
+
+    if (arena)
+    {
+        priv->arena = NULL;
+        scallop_arena_destroy(arena);
+    }
+
+    return index;
+}
+
+//------------------------------------------------------------------------|
+// Run a command already looked up, with its arguments already split, the
+// same way dispatch_line() does once it gets that far.
+static int scallop_invoke_command(scallop_t * scallop,
+                                  scallop_cmd_t * command,
+                                  int argc,
+                                  char ** args)
+{
+    OBJECT_PRIV(, scallop);
+    int result = 0;
+
+    // A construct would push a declaration that no line could ever end
+    if (command->is_construct(command))
+    {
+        priv->console->error(priv->console,
+                             "\'%s\' can only be dispatched as a line",
+                             command->keyword(command));
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    if (priv->depth == 0)
+    {
+        priv->unwind = SCALLOP_UNWIND_NONE;
+    }
+
+    priv->depth++;
+    if (priv->depth > SCALLOP_MAX_RECURS)
+    {
+        priv->console->error(priv->console,
+                             "maximum recursion depth %u reached",
+                             SCALLOP_MAX_RECURS);
+        priv->depth--;
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "exec", args[0], SIZE_MAX);
+    result = command->exec(command, argc, args);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "exec", NULL, 0);
+
+    priv->depth--;
+    return scallop_set_result(scallop, result);
+}
+
+//------------------------------------------------------------------------|
+static int scallop_invoke(scallop_t * scallop, int argc, char ** args)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_cmd_t * command = NULL;
+
+    if (argc < 1 || !args || !args[0])
+    {
+        priv->console->error(priv->console, "expected a command to invoke");
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    command = priv->commands->find_by_keyword(priv->commands, args[0]);
+    if (!command)
+    {
+        priv->console->error(priv->console,
+                             "unknown command \'%s\'.  try \'help\'",
+                             args[0]);
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    return scallop_invoke_command(scallop, command, argc, args);
+}
+
+//------------------------------------------------------------------------|
+static int scallop_invoke_path(scallop_t * scallop,
+                               const char * path,
+                               int argc,
+                               char ** args)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_cmd_t * command = priv->commands;
+    char keyword[SCALLOP_MAX_KEYWORD + 1];
+    const char * c = path;
+    size_t size = 0;
+
+    if (!path || argc < 1 || !args)
+    {
+        priv->console->error(priv->console, "expected a command to invoke");
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    // Walk down one keyword at a time, without copying the whole path
+    while (command && *(c += strspn(c, scallop_cmd_delim)))
+    {
+        size = strcspn(c, scallop_cmd_delim);
+        if (size > SCALLOP_MAX_KEYWORD)
+        {
+            command = NULL;
+            break;
+        }
+
+        memcpy(keyword, c, size);
+        keyword[size] = '\0';
+        command = command->find_by_keyword(command, keyword);
+        c += size;
+    }
+
+    if (!command || command == priv->commands)
+    {
+        priv->console->error(priv->console,
+                             "unknown command \'%s\'.  try \'help\'",
+                             path);
+        return scallop_set_result(scallop, ERROR_MARKER_DEC);
+    }
+
+    return scallop_invoke_command(scallop, command, argc, args);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_dispatches(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    return priv->dispatches;
+}
+
+//------------------------------------------------------------------------|
+static inline scallop_stream_t * scallop_input(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    return priv->input;
+}
+
+//------------------------------------------------------------------------|
+static int scallop_run_console(scallop_t * scallop, bool interactive)
+{
+    OBJECT_PRIV(, scallop);
+    char * line = NULL;
+
+    while (!priv->console->inputf_eof(priv->console) && !priv->quit)
+    {
+        // Anything buffered should be seen before waiting on input
+        if (priv->output_stream)
+        {
+            fflush(priv->output_stream);
+        }
+
+        // Get a line of raw user input
+        line = priv->console->get_line(priv->console,
+                                       priv->prompt->cstr(priv->prompt),
+                                       interactive);
+        if (!line)
+        {
+            SCALLOP_LOG(DEBUG, "get_line() returned NULL");
+            continue;
+        }
+
+        SCALLOP_LOG(DEBUG, "About to dispatch(\'%s\')", line);
+        scallop->dispatch(scallop, line);
+        free(line);
+        line = NULL;
+
+        // Lines from the console or a script are not inside any loop
+        // or routine, so drop any unconsumed break/continue/return.
+        priv->unwind = SCALLOP_UNWIND_NONE;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+// Dispatch each complete line of a block of text where it lies, by
+// terminating it in place.  Returns how much of the text was consumed:
+// anything after the last newline is left for the caller.
+static size_t scallop_dispatch_text(scallop_t * scallop,
+                                    char * text,
+                                    size_t size)
+{
+    OBJECT_PRIV(, scallop);
+    char * line = text;
+    char * end = &text[size];
+    char * newline = NULL;
+
+    while (!priv->quit &&
+           (newline = (char *) memchr(line, '\n', end - line)) != NULL)
+    {
+        *newline = '\0';
+        if (newline > line && newline[-1] == '\r')
+        {
+            newline[-1] = '\0';
+        }
+
+        scallop->dispatch(scallop, line);
+        line = newline + 1;
+
+        // As with run_console(), top-level lines are not inside any
+        // loop or routine.
+        priv->unwind = SCALLOP_UNWIND_NONE;
+    }
+
+    return line - text;
+}
+
+//------------------------------------------------------------------------|
+// Dispatch every line read from a file descriptor, reading in large
+// blocks and dispatching lines in place as they complete.  Returns -1,
+// having reported why, if reading fails.
+static int scallop_dispatch_fd(scallop_t * scallop, int fd)
+{
+    OBJECT_PRIV(, scallop);
+    size_t capacity = SCALLOP_BATCH_BLOCK;
+    size_t used = 0;
+    size_t consumed = 0;
+    ssize_t got = 0;
+    char * buffer = NULL;
+    char * grown = NULL;
+    int result = 0;
+
+    // One extra byte for terminating a final unterminated line
+    buffer = (char *) malloc(capacity + 1);
+    if (!buffer)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", capacity + 1);
+        return -1;
+    }
+
+    while (!priv->quit)
+    {
+        // A line longer than the buffer: make room for more of it
+        if (used == capacity)
+        {
+            grown = (char *) realloc(buffer, 2 * capacity + 1);
+            if (!grown)
+            {
+                BLAMMO(FATAL, "realloc(%zu) failed", 2 * capacity + 1);
+                result = -1;
+                break;
+            }
+
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        // Anything buffered should be seen before waiting on input
+        if (priv->output_stream)
+        {
+            fflush(priv->output_stream);
+        }
+
+        got = read(fd, &buffer[used], capacity - used);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (got < 0)
+        {
+            priv->console->error(priv->console,
+                                 "error reading input: %s",
+                                 strerror(errno));
+            result = -1;
+            break;
+        }
+
+        // At the end of input, the last line needs no newline
+        if (got == 0)
+        {
+            if (used > 0)
+            {
+                if (buffer[used - 1] == '\r')
+                {
+                    used--;
+                }
+
+                buffer[used] = '\0';
+                scallop->dispatch(scallop, buffer);
+                priv->unwind = SCALLOP_UNWIND_NONE;
+            }
+
+            break;
+        }
+
+        // Carry any partial line over to the next block
+        used += got;
+        consumed = scallop_dispatch_text(scallop, buffer, used);
+        used -= consumed;
+        memmove(buffer, &buffer[consumed], used);
+    }
+
+    free(buffer);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static int scallop_run_batch(scallop_t * scallop, void * input)
+{
+    OBJECT_PRIV(, scallop);
+    int result = 0;
+
+    priv->batch = true;
+    result = scallop_dispatch_fd(scallop, fileno((FILE *) input));
+    priv->batch = false;
+    scallop_rebuild_prompt(scallop);
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static int scallop_run_file(scallop_t * scallop, const char * path)
+{
     OBJECT_PRIV(, scallop);
-    BLAMMO(VERBOSE, "priv: %p depth: %u line: %s",
-                    priv, priv->depth, line);
+    struct stat info;
+    size_t size = 0;
+    size_t consumed = 0;
+    size_t length = 0;
+    char * text = NULL;
+    char * last = NULL;
+    int result = 0;
+    int fd = open(path, O_RDONLY);
 
-    // Limit recursion depth here
-    priv->depth++;
-    if (priv->depth > SCALLOP_MAX_RECURS)
+    if (fd < 0)
     {
         priv->console->error(priv->console,
-                             "maximum recursion depth %u reached",
-                             SCALLOP_MAX_RECURS);
-        priv->depth--;
-        scallop_set_result(scallop, ERROR_MARKER_DEC);
-        return;
+                             "could not open %s for reading",
+                             path);
+        return -1;
     }
 
-    // Make an initial copy of the line mainly because we need
-    // to lookup the command that is being specified.  NOTE:
-    // variables as commands are not supported!
-    bytes_t * linebytes = bytes_pub.create(line, strlen(line));
-    size_t argc = 0;
-    char ** args = linebytes->tokenizer(linebytes,
-                                        true,
-                                        scallop_encaps_pairs,
-                                        scallop_cmd_delim,
-                                        scallop_cmd_comment,
-                                        &argc);
-
-    // Ignore empty input
-    if (argc == 0)
+    // Pipes, devices and the like can't be mapped, so they're read
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
     {
-        BLAMMO(VERBOSE, "Ignoring empty tokenized line");
-        linebytes->destroy(linebytes);
-        priv->depth--;
-        // Don't update stored result for empty lines
-        return;
+        result = scallop_dispatch_fd(scallop, fd);
+        close(fd);
+        return result;
     }
 
-    // Try to find the command being invoked
-    scallop_cmd_t * command = priv->commands->find_by_keyword(priv->commands, args[0]);
-    if (!command)
+    // Nothing to map, or to run
+    size = (size_t) info.st_size;
+    if (size == 0)
     {
-        priv->console->error(priv->console,
-                             "unknown command \'%s\'.  try \'help\'",
-                             args[0]);
-
-        linebytes->destroy(linebytes);
-        priv->depth--;
-        scallop_set_result(scallop, ERROR_MARKER_DEC);
-        return;
+        close(fd);
+        return 0;
     }
 
-    // The bottom item on the language stack is the most important
-    // construct declaration that is actively being defined, rather
-    // than executed.  When things are executed, the whole context
-    // becomes unpacked and flattened one construct at a time.
-    scallop_construct_t * declaration = (scallop_construct_t *)
-            priv->constructs->first(priv->constructs);
-
-    // Check if the command is a construct that is about to pop the
-    // last item on the construct stack, meaning this is about to be
-    // the end of this multi-line construct declaration!
-    bool is_end_of_declaration = (command->is_construct_pop(command) &&
-            priv->constructs->length(priv->constructs) == 1);
+    // A private writable mapping lets lines be terminated in place
+    // without touching the file.  Only the pages that hold newlines
+    // are ever copied, by the kernel, and nothing is read up front.
+    text = (char *) mmap(NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, 0);
+    if (text == MAP_FAILED)
+    {
+        BLAMMO(WARNING, "mmap(%s) failed: %s", path, strerror(errno));
+        result = scallop_dispatch_fd(scallop, fd);
+        close(fd);
+        return result;
+    }
 
-    // Check if the command is a declaration modifier like 'else' or
-    // 'private' or 'public'.. something that marks a different
-    // section of the declaration.
-    bool is_declaration_modifier = (command->is_construct_modifier(command) &&
-            priv->constructs->length(priv->constructs) == 1);
+    close(fd);
+    madvise(text, size, MADV_SEQUENTIAL);
+    consumed = scallop_dispatch_text(scallop, text, size);
 
-    // This should not happen, but check anyway just to eliminate
-    // it from the truth table.  'end' without matching 'routine/while/if'?
-    if (is_end_of_declaration && !declaration)
+    // A last line without a newline may end right at the end of the
+    // mapping, with no room to terminate it, so it gets a copy.
+    if (consumed < size && !priv->quit)
     {
-        priv->console->error(priv->console,
-                             "pop command \'%s\' without construct declaration!",
-                             args[0]);
+        length = size - consumed;
+        if (text[size - 1] == '\r')
+        {
+            length--;
+        }
 
-        linebytes->destroy(linebytes);
-        priv->depth--;
-        scallop_set_result(scallop, ERROR_MARKER_DEC);
-        return;
+        last = strndup(&text[consumed], length);
+        if (last)
+        {
+            scallop->dispatch(scallop, last);
+            priv->unwind = SCALLOP_UNWIND_NONE;
+            free(last);
+        }
     }
 
-    // The truth table here gets complicated
-    // TODO: Transfer TT notes to here.
-    int result = 0;
-//    bool call_linefunc = declaration && declaration->linefunc &&
-//                         !is_end_of_declaration;
-    bool call_linefunc = declaration && declaration->linefunc &&
-                         !is_end_of_declaration && !is_declaration_modifier;
+    munmap(text, size);
+    return 0;
+}
 
-    if (call_linefunc)
+//------------------------------------------------------------------------|
+// Buffering is set up on a stream of our own, over a duplicate of the
+// console's descriptor, since a stream's buffering may only be changed
+// before anything has gone through it.
+static bool scallop_buffer_output(scallop_t * scallop, bool enable)
+{
+    OBJECT_PRIV(, scallop);
+    FILE * output = NULL;
+    char * buffer = NULL;
+    int fd = -1;
+
+    if (enable == (priv->output_stream != NULL))
     {
-        // Always add the raw line to the active declaration
-        result = declaration->linefunc(declaration->context,
-                                       declaration->object,
-                                       line);
+        return true;
     }
 
-    if (command->is_construct(command) || !declaration)
+    if (!enable)
     {
-        // Need to make another copy of the line now in execution
-        // so that variable substitution can occur.
-        linebytes->assign(linebytes, line, strlen(line));
+        // Write out what's buffered, then go back to the console's own
+        fflush(priv->output_stream);
+        priv->console->set_outputf(priv->console, priv->output_restore);
+        fclose(priv->output_stream);
+
+        free(priv->output_buffer);
+        priv->output_buffer = NULL;
+        priv->output_stream = NULL;
+        priv->output_restore = NULL;
+        return true;
+    }
 
-        // Preprocessor-like variable substitution needs to happen
-        // before calling tokenize, to allow for supporting spaces
-        // in variables, multiple variables inside arguments, and
-        // complex expression evaluation.
-        // UPDATE 3/14/2024 - suspend substitution when linefunc was called.
-        // variables might not yet be defined!
-        // ALSO: DO NOT EVER substitute for constructs.  This would
-        // cause breakage when executing (ex:) while loops inside routine
-        // because the expression gets prematurely evaluated.
-        if (!call_linefunc && !command->is_construct(command) &&
-                !scallop_substitute_variables(scallop, linebytes))
+    buffer = (char *) malloc(SCALLOP_OUTPUT_BUFFER);
+    if (!buffer)
+    {
+        BLAMMO(FATAL, "malloc(%u) failed", SCALLOP_OUTPUT_BUFFER);
+        return false;
+    }
+
+    priv->output_restore = priv->console->get_outputf(priv->console);
+    fd = dup(fileno(priv->output_restore));
+    output = (fd < 0) ? NULL : fdopen(fd, "w");
+    if (!output || setvbuf(output, buffer, _IOFBF, SCALLOP_OUTPUT_BUFFER) != 0)
+    {
+        BLAMMO(ERROR, "could not buffer output: %s", strerror(errno));
+        if (output)
         {
-            linebytes->destroy(linebytes);
-            priv->depth--;
-            scallop_set_result(scallop, ERROR_MARKER_DEC);
-            return;
+            fclose(output);
         }
-
-        // When a construct command line is being added to a declaration
-        // (of another construct), it is only executed here to track
-        // nesting levels, so it's effectively a dry run.  mark it so.
-        if (call_linefunc && command->is_construct(command))
+        else if (fd >= 0)
         {
-            command->set_attributes(command, SCALLOP_CMD_ATTR_DRY_RUN);
+            close(fd);
         }
 
-        // Re-tokenize now that substitution has occurred.
-        // Assume this copy is going to be OK, since it's been mostly checked already
-        argc = 0;
-        args = linebytes->tokenizer(linebytes,
-                                    true,
-                                    scallop_encaps_pairs,
-                                    scallop_cmd_delim,
-                                    scallop_cmd_comment,
-                                    &argc);
-
-        // Execute the command: calls handler with command, context, and arguments
-        result = command->exec(command, argc, args);
-        // It is the responsibility of the command handler to
-        // clear the dry run bit if it should
+        free(buffer);
+        priv->output_restore = NULL;
+        return false;
     }
 
-    linebytes->destroy(linebytes);
-    priv->depth--;
-    scallop_set_result(scallop, result);
+    // Anything already written goes out ahead of what's buffered
+    fflush(priv->output_restore);
+    priv->console->set_outputf(priv->console, output);
+    priv->output_stream = output;
+    priv->output_buffer = buffer;
+    return true;
 }
 
 //------------------------------------------------------------------------|
-static int scallop_run_console(scallop_t * scallop, bool interactive)
+static void scallop_flush_output(scallop_t * scallop)
 {
     OBJECT_PRIV(, scallop);
-    char * line = NULL;
+    fflush(priv->console->get_outputf(priv->console));
+}
 
-    while (!priv->console->inputf_eof(priv->console) && !priv->quit)
+//------------------------------------------------------------------------|
+static bool scallop_set_cache_dir(scallop_t * scallop, const char * dir)
+{
+    OBJECT_PRIV(, scallop);
+    char * copy = NULL;
+
+    if (dir)
     {
-        // Get a line of raw user input
-        line = priv->console->get_line(priv->console,
-                                       priv->prompt->cstr(priv->prompt),
-                                       interactive);
-        if (!line)
+        copy = strdup(dir);
+        if (!copy)
         {
-            BLAMMO(DEBUG, "get_line() returned NULL");
-            continue;
+            BLAMMO(FATAL, "strdup(%s) failed", dir);
+            return false;
         }
-
-        BLAMMO(DEBUG, "About to dispatch(\'%s\')", line);
-        scallop->dispatch(scallop, line);
-        free(line);
-        line = NULL;
     }
 
-    return 0;
+    free(priv->cache_dir);
+    priv->cache_dir = copy;
+    return true;
 }
 
 //------------------------------------------------------------------------|
-static int scallop_run_lines(scallop_t * scallop, void * lines_ptr)
+static inline const char * scallop_cache_dir(scallop_t * scallop)
 {
-    chain_t * lines = (chain_t *) lines_ptr;
-    bytes_t * line = (bytes_t *) lines->first(lines);
+    OBJECT_PRIV(, scallop);
+    return priv->cache_dir;
+}
 
-    // Iterate through all lines and dispatch each
-    while (line)
+//------------------------------------------------------------------------|
+static int scallop_run_lines(scallop_t * scallop, void * lines_ptr)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_lines_t * lines = (scallop_lines_t *) lines_ptr;
+    size_t count = lines->count(lines);
+    size_t index = 0;
+    int result = 0;
+    bool profiling = scallop_cmd_pub.is_profiling();
+    scallop_lines_stats_t * stats = NULL;
+    scallop_lines_stats_t * origin = NULL;
+    scallop_lines_stats_t * previous = NULL;
+    uint64_t elapsed = 0;
+    bool storing = false;
+
+    priv->running++;
+
+    // Iterate through all lines and dispatch each.  Lines are fetched
+    // by index on every pass rather than cached up front, because the
+    // stored pointers are only stable until the next append.
+    for (index = 0; index < count; index++)
     {
-        BLAMMO(DEBUG, "About to dispatch(\'%s\')",
-                      line->cstr(line));
+        SCALLOP_LOG(DEBUG, "About to dispatch(\'%s\')",
+                           lines->line(lines, index));
+
+        // Dispatch (run) the line, timing it if profiling.  Any lines
+        // it stores, as for a nested loop body, are charged back to the
+        // same place this one is, ultimately the outermost stored line.
+        // Lines that are only being stored are not counted until run.
+        if (profiling)
+        {
+            stats = lines->stats(lines, index);
+            origin = lines->origin(lines, index);
+            previous = lines->set_origin(origin ? origin : stats);
+            storing = !priv->constructs->empty(priv->constructs);
+
+            elapsed = scallop_clock_ns();
+            scallop->dispatch(scallop, lines->line(lines, index));
+            elapsed = scallop_clock_ns() - elapsed;
+
+            lines->set_origin(previous);
+            storing &= !priv->constructs->empty(priv->constructs);
+            if (storing)
+            {
+                stats = NULL;
+                origin = NULL;
+            }
+
+            if (stats)
+            {
+                stats->hits++;
+                stats->total_ns += elapsed;
+            }
+
+            if (origin)
+            {
+                origin->hits++;
+                origin->total_ns += elapsed;
+            }
+        }
+        else
+        {
+            scallop->dispatch(scallop, lines->line(lines, index));
+        }
 
-        // Dispatch (run) the line
-        scallop->dispatch(scallop, (char *) line->cstr(line));
+        result = priv->result;
 
-        // Get next line
-        line = (bytes_t *) lines->next(lines);
+        // Skip the rest of the body on break, continue or return.
+        // It's up to the enclosing loop or routine to consume it.
+        if (priv->unwind != SCALLOP_UNWIND_NONE)
+        {
+            SCALLOP_LOG(DEBUG, "unwinding %d at line %zu", priv->unwind, index);
+            break;
+        }
     }
 
-    return 0;
+    priv->running--;
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_unwind(scallop_t * scallop, scallop_unwind_t unwind)
+{
+    OBJECT_PRIV(, scallop);
+
+    if (unwind != SCALLOP_UNWIND_NONE && priv->running == 0)
+    {
+        return false;
+    }
+
+    priv->unwind = unwind;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static inline scallop_unwind_t scallop_unwinding(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    return priv->unwind;
 }
 
 //------------------------------------------------------------------------|
@@ -1110,6 +2945,13 @@ static void scallop_quit(scallop_t * scallop)
     // This might not be known until threads are implemented.
 }
 
+//------------------------------------------------------------------------|
+static inline bool scallop_quitting(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    return priv->quit;
+}
+
 //------------------------------------------------------------------------|
 static void scallop_construct_push(scallop_t * scallop,
                                    const char * name,
@@ -1133,6 +2975,8 @@ static void scallop_construct_push(scallop_t * scallop,
     // the top of the stack.  New construct becomes the new 'last'
     priv->constructs->last(priv->constructs);
     priv->constructs->insert(priv->constructs, construct);
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_CONSTRUCT,
+                        "construct", name, SIZE_MAX);
 
     scallop_rebuild_prompt(scallop);
 }
@@ -1166,6 +3010,8 @@ static int scallop_construct_pop(scallop_t * scallop)
     // until well after popping, but ephemeral constructs may execute
     // upon being popped.
     priv->constructs->remove(priv->constructs);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_CONSTRUCT,
+                        "construct", NULL, 0);
 
     // Call the pop function if one is provided
     int result = 0;
@@ -1193,6 +3039,105 @@ static void * scallop_construct_object(scallop_t * scallop)
     return NULL;
 }
 
+//------------------------------------------------------------------------|
+static const char * scallop_construct_name(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_construct_t * declaration = (scallop_construct_t *)
+            priv->constructs->first(priv->constructs);
+
+    if (declaration)
+    {
+        return declaration->name;
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_store_line(scallop_t * scallop, const char * line)
+{
+    OBJECT_PRIV(, scallop);
+    scallop_construct_t * declaration = NULL;
+    int result = 0;
+
+    if (priv->constructs->length(priv->constructs) != 1)
+    {
+        return false;
+    }
+
+    declaration = (scallop_construct_t *)
+            priv->constructs->first(priv->constructs);
+    if (!declaration || !declaration->linefunc)
+    {
+        return false;
+    }
+
+    // Counted, traced and leaving its result just as a dispatch would
+    priv->dispatches++;
+    scallop_trace_event(priv, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "dispatch", line, SIZE_MAX);
+    result = declaration->linefunc(declaration->context,
+                                   declaration->object,
+                                   line);
+    scallop_trace_event(priv, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                        "dispatch", NULL, 0);
+    scallop_set_result(scallop, result);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_trace_start(scallop_t * scallop, size_t capacity)
+{
+    OBJECT_PRIV(, scallop);
+
+    // Reallocate only for a different capacity, so that restarting
+    // doesn't churn through a large buffer.
+    if (priv->trace && capacity && capacity != priv->trace_capacity)
+    {
+        priv->trace->destroy(priv->trace);
+        priv->trace = NULL;
+    }
+
+    if (!priv->trace)
+    {
+        priv->trace = scallop_trace_pub.create(capacity);
+        if (!priv->trace)
+        {
+            priv->console->error(priv->console,
+                                 "could not allocate trace buffer");
+            priv->tracing = false;
+            return false;
+        }
+
+        priv->trace_capacity = capacity;
+    }
+
+    priv->trace->clear(priv->trace);
+    priv->tracing = true;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_trace_stop(scallop_t * scallop)
+{
+    OBJECT_PRIV(, scallop);
+    priv->tracing = false;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_trace_dump(scallop_t * scallop, const char * path)
+{
+    OBJECT_PRIV(, scallop);
+
+    if (!priv->trace)
+    {
+        return false;
+    }
+
+    return priv->trace->dump(priv->trace, path);
+}
+
 //------------------------------------------------------------------------|
 const scallop_t scallop_pub = {
     &scallop_create,
@@ -1202,15 +3147,49 @@ const scallop_t scallop_pub = {
     &scallop_routine_by_name,
     &scallop_routine_insert,
     &scallop_routine_remove,
+    &scallop_list_by_name,
+    &scallop_list_insert,
+    &scallop_list_remove,
+    &scallop_map_by_name,
+    &scallop_map_insert,
+    &scallop_map_remove,
+    &scallop_routines,
     &scallop_store_args,
     &scallop_assign_variable,
+    &scallop_next_variable,
+    &scallop_provide_variable,
+    &scallop_unprovide_variable,
+    &scallop_substitute,
     &scallop_evaluate_condition,
+    &scallop_evaluate_value,
+    &scallop_bind_counter,
+    &scallop_bind_item,
+    &scallop_unbind,
     &scallop_dispatch,
+    &scallop_dispatch_batch,
+    &scallop_invoke,
+    &scallop_invoke_path,
+    &scallop_dispatches,
+    &scallop_input,
     &scallop_run_console,
+    &scallop_run_batch,
+    &scallop_run_file,
+    &scallop_buffer_output,
+    &scallop_flush_output,
+    &scallop_set_cache_dir,
+    &scallop_cache_dir,
     &scallop_run_lines,
+    &scallop_unwind,
+    &scallop_unwinding,
     &scallop_quit,
+    &scallop_quitting,
     &scallop_construct_push,
     &scallop_construct_pop,
     &scallop_construct_object,
+    &scallop_construct_name,
+    &scallop_store_line,
+    &scallop_trace_start,
+    &scallop_trace_stop,
+    &scallop_trace_dump,
     NULL
 };
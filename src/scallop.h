@@ -31,6 +31,10 @@
 #include "console.h"
 #include "command.h"
 #include "routine.h"
+#include "list.h"
+#include "map.h"
+#include "trace.h"
+#include "stream.h"
 
 //------------------------------------------------------------------------|
 // Arbitrary maximum recursion depth to avoid stack smashing
@@ -46,6 +50,26 @@ typedef int (*scallop_construct_line_f)(void * context,
 typedef int (*scallop_construct_pop_f)(void * context,
                                        void * object);
 
+// Early exit requests from within running lines.  These are raised by
+// 'break', 'continue' and 'return' and consumed by whichever enclosing
+// loop or routine they are meant for.  'break' and 'continue' do not
+// cross routine boundaries.
+typedef enum
+{
+    SCALLOP_UNWIND_NONE = 0,
+    SCALLOP_UNWIND_BREAK,
+    SCALLOP_UNWIND_CONTINUE,
+    SCALLOP_UNWIND_RETURN
+}
+scallop_unwind_t;
+
+// Host callback computing a variable's value (into a bytes_t *) whenever
+// it's referenced.  Returns false if it has no value, as for a variable
+// that is not found.
+typedef bool (*scallop_provider_f)(void * object,
+                                   const char * name,
+                                   void * value);
+
 // Callback for registration of default commands on scallop->create().
 // Normally one would pass in register_builtin_commands() to get all the
 // default functionality.  Alternatively one could create something
@@ -81,6 +105,34 @@ typedef struct scallop_t
     void (*routine_remove)(struct scallop_t * scallop,
                            const char * name);
 
+    // Get a list variable by name.  Returns NULL if not found.
+    scallop_list_t * (*list_by_name)(struct scallop_t * scallop,
+                                     const char * name);
+
+    // Create a new empty list variable, replacing any by the same name
+    scallop_list_t * (*list_insert)(struct scallop_t * scallop,
+                                    const char * name);
+
+    // Remove and destroy a list variable
+    void (*list_remove)(struct scallop_t * scallop,
+                        const char * name);
+
+    // Get a map variable by name.  Returns NULL if not found.
+    scallop_map_t * (*map_by_name)(struct scallop_t * scallop,
+                                   const char * name);
+
+    // Create a new empty map variable, replacing any by the same name
+    scallop_map_t * (*map_insert)(struct scallop_t * scallop,
+                                  const char * name);
+
+    // Remove and destroy a map variable
+    void (*map_remove)(struct scallop_t * scallop,
+                       const char * name);
+
+    // Get access to the list of all defined routines (a chain_t *
+    // of scallop_rtn_t *).  Intended for reporting, not modification.
+    void * (*routines)(struct scallop_t * scallop);
+
     // Put a set of routine arguments into the environment to be
     // picked up later on evaluation/substitution.  This will
     // intrinsically prefix everything to avoid trampling on other
@@ -89,11 +141,43 @@ typedef struct scallop_t
                        int argc,
                        char ** args);
 
-    // Assign a variable value to scallop's environment
-    void (*assign_variable)(struct scallop_t * scallop,
+    // Assign a variable value to scallop's environment.  A name bound by
+    // a loop is written through to its counter or list item instead (see
+    // bind_counter()).  Returns false, having reported why, if the bound
+    // counter or item can't take the value.
+    bool (*assign_variable)(struct scallop_t * scallop,
                             const char * varname,
                             const char * varvalue);
 
+    // Iterate over all variables assigned, in no particular order, but
+    // not routine arguments or results.  Start with *cursor at zero, and
+    // call until false is returned, without assigning in between.
+    bool (*next_variable)(struct scallop_t * scallop,
+                          size_t * cursor,
+                          const char ** varname,
+                          const char ** varvalue);
+
+    // Have a variable's value computed by the host only when a reference
+    // to it is substituted or evaluated, instead of being assigned ahead
+    // of time whether used or not.  With cache, the value is computed at
+    // most once for each line dispatched.  Providers come ahead of any
+    // variable assigned by the same name, but not loop variables, and
+    // replace any earlier provider by that name.  Returns false if the
+    // provider can't be added.
+    bool (*provide_variable)(struct scallop_t * scallop,
+                             const char * name,
+                             scallop_provider_f provider,
+                             void * object,
+                             bool cache);
+
+    // Remove a variable's provider.  Returns false if it had none.
+    bool (*unprovide_variable)(struct scallop_t * scallop, const char * name);
+
+    // Replace all variable references in text (must be a bytes_t *) with
+    // their current values, as is done for each line before it runs.
+    // Returns false, having reported why, if any reference is not found.
+    bool (*substitute)(struct scallop_t * scallop, void * text);
+
     // Evaluate a conditional expression, including variable references,
     // as with a while loop or if-else construct.
     // ex: "while ({i} < 3)" or "if ({x} == 5)"
@@ -101,20 +185,135 @@ typedef struct scallop_t
                                const char * condition,
                                size_t size);
 
+    // Evaluate a single numeric value, including variable references.
+    // This may be either an expression or a plain integer, as with the
+    // range of a for loop.  ex: "10" or "{n}" or "({n} - 1)"
+    // Returns false if the text does not evaluate to a number.
+    bool (*evaluate_value)(struct scallop_t * scallop,
+                           const char * text,
+                           size_t size,
+                           long * value);
+
+    // Bind a variable name directly to a native integer counter, as with
+    // a for loop.  References to the name resolve to the counter's current
+    // value, formatted only when referenced, ahead of any variable stored
+    // by that name, and assigning the name sets the counter.  Bindings
+    // are strictly nested: unbind() always removes the most recent.  The
+    // name and counter must outlive the binding.  Returns false if too
+    // many names are already bound.
+    bool (*bind_counter)(struct scallop_t * scallop,
+                         const char * name,
+                         long * counter);
+
+    // Bind a variable name to the item of a list variable at a native
+    // index, as with a foreach loop.  The list is looked up by name on
+    // each reference.  Otherwise the same as bind_counter().
+    bool (*bind_item)(struct scallop_t * scallop,
+                      const char * name,
+                      const char * list,
+                      long * index);
+
+    // Remove the most recent binding
+    void (*unbind)(struct scallop_t * scallop);
+
     // Handle a raw line of input, calling whatever
-    // handler functions are necessary.
+    // handler functions are necessary.  Commands separated by '|' are run
+    // as a pipeline (see input()), and output may be sent to a file with
+    // "> file" or appended to one with ">> file" at the end of the line.
     void (*dispatch)(struct scallop_t * scallop, const char * line);
 
+    // Dispatch each of an array of lines in turn, as dispatch() would,
+    // but sharing one set of scratch buffers across all of them and
+    // remembering the commands looked up along the way.  Stops early if
+    // quit is requested.  Unless results is NULL, each line's result is
+    // stored there, as "%?" would be after it: blank lines leave the one
+    // before.  Returns the number of lines dispatched.
+    size_t (*dispatch_batch)(struct scallop_t * scallop,
+                             const char * const * lines,
+                             size_t count,
+                             int * results);
+
+    // Run a command straight from its keyword and arguments, as handlers
+    // get them, without making a line of them: no tokenizing, variable
+    // substitution, pipelines or redirection.  args[0] is the keyword.
+    // The result is stored as from dispatch(), for "%?", and returned.
+    // Constructs can't be run this way.  ex: {"assign", "x", "5"}
+    int (*invoke)(struct scallop_t * scallop, int argc, char ** args);
+
+    // Same as invoke(), but for a nested command found by the keywords
+    // leading to it, separated by spaces, rather than through its parent
+    // command's handler.  args[0] is still the command's own keyword.
+    // ex: invoke_path(scallop, "list push", 3, {"push", "fruit", "kiwi"})
+    int (*invoke_path)(struct scallop_t * scallop,
+                       const char * path,
+                       int argc,
+                       char ** args);
+
+    // Get the number of lines dispatched so far, nested or not.  The
+    // difference across some activity says how much dispatching it did.
+    size_t (*dispatches)(struct scallop_t * scallop);
+
+    // Get the input of the command running, as piped to it from the one
+    // before it, ex: "help | print".  NULL if nothing is piped in.  A
+    // command's own output is captured simply by printing to the console.
+    // Routines pass their input on to the lines they run.
+    scallop_stream_t * (*input)(struct scallop_t * scallop);
+
     // Main interactive prompt loop: for console or source file
     int (*run_console)(struct scallop_t * scallop, bool interactive);
 
-    // Run a given set of lines (must be a chain_t * type) as from
-    // a routine or part of a while loop or if-else statement.
+    // Non-interactive loop for piped or generated input (a FILE *).
+    // Reads in large blocks and dispatches each line in place, skipping
+    // the console's line editor, history and prompts entirely.  Returns
+    // -1, having reported why, if reading the input fails.
+    int (*run_batch)(struct scallop_t * scallop, void * input);
+
+    // Run a script file, as with 'source'.  The file is memory-mapped and
+    // its lines dispatched straight from the mapping: they are only
+    // copied if a construct stores them.  What can't be mapped, such as a
+    // pipe, is read in blocks as run_batch() does.  Returns -1 if the
+    // file can't be opened or read, having reported why.
+    int (*run_file)(struct scallop_t * scallop, const char * path);
+
+    // Buffer console output in one large block, rather than as the output
+    // stream would on its own (a line at a time on a terminal).  Output
+    // is written when the block fills, on flush_output(), and before
+    // waiting on more input.  Meanwhile the console writes to a stream of
+    // scallop's own, on the same descriptor, which is what its
+    // get_outputf() returns.  Returns false if buffering can't be set up.
+    bool (*buffer_output)(struct scallop_t * scallop, bool enable);
+
+    // Write out any buffered console output now
+    void (*flush_output)(struct scallop_t * scallop);
+
+    // Set a directory for 'source' to keep compiled scripts in, so that
+    // unchanged scripts needn't be parsed again (see script.h).  NULL
+    // turns compiled scripts off, which is the default.  Returns false
+    // if the path can't be copied.
+    bool (*set_cache_dir)(struct scallop_t * scallop, const char * dir);
+
+    // Get the compiled script directory, or NULL if there is none
+    const char * (*cache_dir)(struct scallop_t * scallop);
+
+    // Run a given set of lines (must be a scallop_lines_t * type) as
+    // from a routine or part of a while loop or if-else statement.
+    // Returns the result of the last line run, as would be seen in "%?"
     int (*run_lines)(struct scallop_t * scallop, void * lines);
 
+    // Stop running lines early and unwind out to the nearest enclosing
+    // loop or routine.  Returns false if no lines are running, as from
+    // the interactive prompt.  Pass SCALLOP_UNWIND_NONE to clear.
+    bool (*unwind)(struct scallop_t * scallop, scallop_unwind_t unwind);
+
+    // Get the pending unwind request, if any
+    scallop_unwind_t (*unwinding)(struct scallop_t * scallop);
+
     // Explicitly quit the main loop
     void (*quit)(struct scallop_t * scallop);
 
+    // Get whether quit has been requested
+    bool (*quitting)(struct scallop_t * scallop);
+
     // Push a full context onto the context stack
     void (*construct_push)(struct scallop_t * scallop,
                          const char * name,
@@ -130,6 +329,30 @@ typedef struct scallop_t
     // as this represents the current construct declaration
     void * (*construct_object)(struct scallop_t * scallop);
 
+    // Get the name the same construct was pushed with, which tells what
+    // kind of object construct_object() is.  NULL if there is none.
+    const char * (*construct_name)(struct scallop_t * scallop);
+
+    // Add a raw line to the construct declaration being defined, as
+    // dispatch() does for a line inside one that is neither the end nor
+    // a modifier of it, without looking the line up or running it.  The
+    // line is counted, traced and leaves a result the same as well.
+    // Returns false unless exactly one construct is being defined.
+    bool (*store_line)(struct scallop_t * scallop, const char * line);
+
+    // Start recording trace events for dispatches, command execution,
+    // construct pushes and pops, and expression evaluation into a ring
+    // buffer of the given number of events (0 for the default).  Any
+    // events from a previous trace are discarded.
+    bool (*trace_start)(struct scallop_t * scallop, size_t capacity);
+
+    // Stop recording trace events, keeping those recorded
+    void (*trace_stop)(struct scallop_t * scallop);
+
+    // Write recorded trace events to a file as Chrome trace-event JSON.
+    // Returns false if nothing was traced or the file can't be written.
+    bool (*trace_dump)(struct scallop_t * scallop, const char * path);
+
     // Private data
     void * priv;
 }
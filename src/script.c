@@ -0,0 +1,853 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "script.h"
+#include "scallop.h"
+#include "command.h"
+
+//------------------------------------------------------------------------|
+// "SCC1" in a native integer, which also catches files from a machine of
+// the other byte order
+#define SCALLOP_SCRIPT_MAGIC        0x31434353
+
+// Line keyword for lines that are always dispatched
+#define SCALLOP_SCRIPT_DISPATCH     UINT32_MAX
+
+// Initial room for keywords and lines while compiling
+#define SCALLOP_SCRIPT_INITIAL      64
+
+// Initial room for a source that has to be read rather than mapped
+#define SCALLOP_SCRIPT_READ_BLOCK   65536
+
+//------------------------------------------------------------------------|
+// The compiled form is this header, then the keywords, then the lines,
+// then the text that both refer to by offset, as terminated strings.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;
+    uint64_t source_size;
+    uint32_t keywords;
+    uint32_t lines;
+    uint64_t text_size;
+}
+scallop_script_header_t;
+
+// A line, and the keyword of the plain command it starts with, or
+// SCALLOP_SCRIPT_DISPATCH.
+typedef struct
+{
+    uint32_t text;
+    uint32_t keyword;
+}
+scallop_script_line_t;
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    scallop_t * scallop;
+    char * path;
+
+    // Read-only mapping of the source, or a copy read from a pipe or
+    // the like that can't be mapped.  NULL for an empty file.
+    const char * source;
+    size_t source_size;
+    bool source_mapped;
+    uint64_t hash;
+
+    // Compiled form, either mapped from the cache or built by compile()
+    void * image;
+    size_t image_size;
+    bool mapped;
+
+    // Parts of the image
+    const uint32_t * keywords;
+    const scallop_script_line_t * lines;
+    const char * text;
+    uint32_t keyword_count;
+    uint32_t line_count;
+}
+scallop_script_priv_t;
+
+//------------------------------------------------------------------------|
+// Command line delimiters, as in dispatch
+static inline bool scallop_script_is_delim(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' ||
+           c == '\r' || c == '\f' || c == '\v';
+}
+
+//------------------------------------------------------------------------|
+// Find the next source line, without terminating it or any carriage
+// return, and move past it.  Returns false at the end of the source.
+static bool scallop_script_next(const char ** line,
+                                const char * end,
+                                const char ** start,
+                                const char ** stop)
+{
+    const char * newline = NULL;
+
+    if (*line >= end)
+    {
+        return false;
+    }
+
+    *start = *line;
+    newline = (const char *) memchr(*line, '\n', end - *line);
+    *stop = newline ? newline : end;
+    *line = newline ? newline + 1 : end;
+    if (*stop > *start && (*stop)[-1] == '\r')
+    {
+        (*stop)--;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Skip leading delimiters.  A line is blank, with nothing to run, if this
+// reaches its stop or a comment.
+static inline const char * scallop_script_skip(const char * start,
+                                               const char * stop)
+{
+    while (start < stop && scallop_script_is_delim(*start))
+    {
+        start++;
+    }
+
+    return start;
+}
+
+//------------------------------------------------------------------------|
+// 64-bit FNV-1a, for naming the compiled form after the source
+static uint64_t scallop_script_fnv1a(const char * data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t index = 0;
+
+    for (index = 0; index < size; index++)
+    {
+        hash ^= (unsigned char) data[index];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_script_unload(scallop_script_priv_t * priv)
+{
+    if (priv->mapped)
+    {
+        munmap(priv->image, priv->image_size);
+    }
+    else
+    {
+        free(priv->image);
+    }
+
+    priv->image = NULL;
+    priv->image_size = 0;
+    priv->mapped = false;
+    priv->keywords = NULL;
+    priv->lines = NULL;
+    priv->text = NULL;
+    priv->keyword_count = 0;
+    priv->line_count = 0;
+}
+
+//------------------------------------------------------------------------|
+// Read a whole source that can't be mapped into a private copy
+static bool scallop_script_read(scallop_script_priv_t * priv, int fd)
+{
+    size_t capacity = SCALLOP_SCRIPT_READ_BLOCK;
+    char * source = (char *) malloc(capacity);
+    char * grown = NULL;
+    ssize_t got = 0;
+
+    if (!source)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", capacity);
+        return false;
+    }
+
+    priv->source = source;
+    priv->source_size = 0;
+    priv->source_mapped = false;
+    while (true)
+    {
+        if (priv->source_size == capacity)
+        {
+            grown = (char *) realloc(source, 2 * capacity);
+            if (!grown)
+            {
+                BLAMMO(FATAL, "realloc(%zu) failed", 2 * capacity);
+                return false;
+            }
+
+            source = grown;
+            priv->source = source;
+            capacity *= 2;
+        }
+
+        got = read(fd, &source[priv->source_size],
+                   capacity - priv->source_size);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (got < 0)
+        {
+            BLAMMO(ERROR, "read(%s) failed: %s", priv->path, strerror(errno));
+            return false;
+        }
+        else if (got == 0)
+        {
+            return true;
+        }
+
+        priv->source_size += got;
+    }
+}
+
+//------------------------------------------------------------------------|
+static scallop_script_t * scallop_script_create(void * scallop,
+                                                const char * path)
+{
+    OBJECT_ALLOC(scallop_, script);
+    struct stat info;
+    void * source = NULL;
+    int fd = -1;
+
+    priv->scallop = (scallop_t *) scallop;
+    priv->path = strdup(path);
+    if (!priv->path)
+    {
+        BLAMMO(FATAL, "strdup(%s) failed", path);
+        script->destroy(script);
+        return NULL;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        script->destroy(script);
+        return NULL;
+    }
+
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        script->destroy(script);
+        return NULL;
+    }
+
+    // Pipes, devices and the like can't be mapped, so they're read
+    priv->source_size = (size_t) info.st_size;
+    if (S_ISREG(info.st_mode) && priv->source_size > 0)
+    {
+        source = mmap(NULL, priv->source_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (source == MAP_FAILED)
+        {
+            BLAMMO(WARNING, "mmap(%s) failed: %s", path, strerror(errno));
+        }
+        else
+        {
+            priv->source = (const char *) source;
+            priv->source_mapped = true;
+        }
+    }
+
+    if (!priv->source_mapped &&
+        (!S_ISREG(info.st_mode) || priv->source_size > 0) &&
+        !scallop_script_read(priv, fd))
+    {
+        close(fd);
+        script->destroy(script);
+        return NULL;
+    }
+
+    close(fd);
+    priv->hash = scallop_script_fnv1a(priv->source, priv->source_size);
+    return script;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_script_destroy(void * script_ptr)
+{
+    OBJECT_PTR(scallop_, script, script_ptr, );
+
+    scallop_script_unload(priv);
+
+    if (priv->source_mapped)
+    {
+        munmap((void *) priv->source, priv->source_size);
+    }
+    else
+    {
+        free((void *) priv->source);
+    }
+
+    free(priv->path);
+    OBJECT_FREE(scallop_, script);
+}
+
+//------------------------------------------------------------------------|
+// Check that each keyword is still a plain command, as they are the ones
+// whose lines may be stored without a lookup.
+static bool scallop_script_check(scallop_script_priv_t * priv)
+{
+    scallop_cmd_t * cmds = priv->scallop->commands(priv->scallop);
+    scallop_cmd_t * cmd = NULL;
+    uint32_t index = 0;
+
+    for (index = 0; index < priv->keyword_count; index++)
+    {
+        cmd = cmds->find_by_keyword(cmds, &priv->text[priv->keywords[index]]);
+        if (!cmd || cmd->is_construct(cmd))
+        {
+            BLAMMO(INFO, "%s is no longer a plain command",
+                         &priv->text[priv->keywords[index]]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Find the parts of an image, and check that they fit in it and belong
+// to this source.
+static bool scallop_script_parse(scallop_script_priv_t * priv)
+{
+    const scallop_script_header_t * header = NULL;
+    uint64_t size = sizeof(scallop_script_header_t);
+    uint32_t index = 0;
+
+    if (priv->image_size < size)
+    {
+        return false;
+    }
+
+    header = (const scallop_script_header_t *) priv->image;
+    if (header->magic != SCALLOP_SCRIPT_MAGIC ||
+        header->version != SCALLOP_SCRIPT_VERSION ||
+        header->hash != priv->hash ||
+        header->source_size != priv->source_size)
+    {
+        return false;
+    }
+
+    size += (uint64_t) header->keywords * sizeof(uint32_t);
+    size += (uint64_t) header->lines * sizeof(scallop_script_line_t);
+    size += header->text_size;
+    if (size != priv->image_size ||
+        (header->text_size > 0 &&
+         ((const char *) priv->image)[priv->image_size - 1] != '\0'))
+    {
+        return false;
+    }
+
+    priv->keywords = (const uint32_t *) &header[1];
+    priv->lines = (const scallop_script_line_t *)
+            &priv->keywords[header->keywords];
+    priv->text = (const char *) &priv->lines[header->lines];
+    priv->keyword_count = header->keywords;
+    priv->line_count = header->lines;
+
+    for (index = 0; index < priv->keyword_count; index++)
+    {
+        if (priv->keywords[index] >= header->text_size)
+        {
+            return false;
+        }
+    }
+
+    for (index = 0; index < priv->line_count; index++)
+    {
+        if (priv->lines[index].text >= header->text_size ||
+            (priv->lines[index].keyword != SCALLOP_SCRIPT_DISPATCH &&
+             priv->lines[index].keyword >= priv->keyword_count))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// The hash only names the compiled form, so before trusting one, check
+// that its lines are exactly the source's lines that aren't blank, in
+// order.  This costs one comparison per line, and no lookups.
+static bool scallop_script_verify(scallop_script_priv_t * priv)
+{
+    const char * line = priv->source;
+    const char * end = priv->source + priv->source_size;
+    const char * start = NULL;
+    const char * stop = NULL;
+    const char * after = NULL;
+    const char * compiled = NULL;
+    size_t length = 0;
+    uint32_t index = 0;
+
+    while (scallop_script_next(&line, end, &start, &stop))
+    {
+        after = scallop_script_skip(start, stop);
+        if (after == stop || *after == '#')
+        {
+            continue;
+        }
+
+        if (index >= priv->line_count)
+        {
+            return false;
+        }
+
+        compiled = &priv->text[priv->lines[index++].text];
+        length = stop - start;
+        if (strnlen(compiled, length + 1) != length ||
+            memcmp(compiled, start, length) != 0)
+        {
+            return false;
+        }
+    }
+
+    return index == priv->line_count;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_script_load(scallop_script_t * script, const char * dir)
+{
+    OBJECT_PRIV(scallop_, script);
+    struct stat info;
+    bytes_t * path = NULL;
+    void * image = NULL;
+    int fd = -1;
+
+    scallop_script_unload(priv);
+
+    path = bytes_pub.print_create("%s/%016llx%s", dir,
+                                  (unsigned long long) priv->hash,
+                                  SCALLOP_SCRIPT_EXTENSION);
+    fd = open(path->cstr(path), O_RDONLY);
+    path->destroy(path);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+        info.st_size < (off_t) sizeof(scallop_script_header_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    image = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+    {
+        return false;
+    }
+
+    priv->image = image;
+    priv->image_size = (size_t) info.st_size;
+    priv->mapped = true;
+
+    if (!scallop_script_parse(priv) ||
+        !scallop_script_verify(priv) ||
+        !scallop_script_check(priv))
+    {
+        scallop_script_unload(priv);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Make sure there is room for one more item in a growing array
+static bool scallop_script_reserve(void ** array,
+                                   size_t * capacity,
+                                   size_t count,
+                                   size_t item)
+{
+    void * grown = NULL;
+
+    if (count < *capacity)
+    {
+        return true;
+    }
+
+    grown = realloc(*array, 2 * *capacity * item);
+    if (!grown)
+    {
+        BLAMMO(FATAL, "realloc(%zu) failed", 2 * *capacity * item);
+        return false;
+    }
+
+    *array = grown;
+    *capacity *= 2;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_script_compile(scallop_script_t * script)
+{
+    OBJECT_PRIV(scallop_, script);
+    scallop_cmd_t * cmds = priv->scallop->commands(priv->scallop);
+    scallop_cmd_t * cmd = NULL;
+    scallop_script_header_t header;
+    bytes_t * text = NULL;
+    uint32_t * keywords = NULL;
+    scallop_script_line_t * lines = NULL;
+    size_t keyword_capacity = SCALLOP_SCRIPT_INITIAL;
+    size_t line_capacity = SCALLOP_SCRIPT_INITIAL;
+    size_t keyword_count = 0;
+    size_t line_count = 0;
+    const char * line = priv->source;
+    const char * end = priv->source + priv->source_size;
+    const char * stop = NULL;
+    const char * start = NULL;
+    const char * first = NULL;
+    const char * after = NULL;
+    const char * known = NULL;
+    char * cursor = NULL;
+    uint32_t keyword = 0;
+    size_t offset = 0;
+    size_t index = 0;
+    bool plain = false;
+    bool success = false;
+
+    scallop_script_unload(priv);
+
+    // Offsets are 32 bits, and the text is at most a little more than
+    // the source, with keywords.
+    if (priv->source_size >= UINT32_MAX / 2)
+    {
+        return false;
+    }
+
+    text = bytes_pub.create(NULL, 0);
+    keywords = (uint32_t *) malloc(keyword_capacity * sizeof(uint32_t));
+    lines = (scallop_script_line_t *)
+            malloc(line_capacity * sizeof(scallop_script_line_t));
+    if (!text || !keywords || !lines)
+    {
+        BLAMMO(FATAL, "compile allocation failed");
+        goto done;
+    }
+
+    // Same line splitting as run_file(), without terminating
+    while (scallop_script_next(&line, end, &start, &stop))
+    {
+        after = scallop_script_skip(start, stop);
+
+        // Nothing to run: blank or comment-only
+        if (after == stop || *after == '#')
+        {
+            continue;
+        }
+
+        // Lines are dispatched unless they start with a plain command
+        // spelled out as is, not quoted or otherwise encapsulated.
+        keyword = SCALLOP_SCRIPT_DISPATCH;
+        first = after;
+        plain = true;
+        while (after < stop && !scallop_script_is_delim(*after))
+        {
+            plain &= !strchr("\"(){}#", *after);
+            after++;
+        }
+
+        // Interned keywords are few, so a linear search will do
+        for (index = 0; plain && index < keyword_count; index++)
+        {
+            known = &text->cstr(text)[keywords[index]];
+            if (!strncmp(known, first, after - first) &&
+                known[after - first] == '\0')
+            {
+                keyword = (uint32_t) index;
+                break;
+            }
+        }
+
+        if (plain && keyword == SCALLOP_SCRIPT_DISPATCH)
+        {
+            offset = text->size(text);
+            text->append(text, first, after - first);
+            text->append(text, "", 1);
+
+            cmd = cmds->find_by_keyword(cmds, &text->cstr(text)[offset]);
+            if (cmd && !cmd->is_construct(cmd))
+            {
+                if (!scallop_script_reserve((void **) &keywords,
+                                            &keyword_capacity,
+                                            keyword_count,
+                                            sizeof(uint32_t)))
+                {
+                    goto done;
+                }
+
+                keywords[keyword_count] = (uint32_t) offset;
+                keyword = (uint32_t) keyword_count++;
+            }
+            else
+            {
+                // Not kept, so give the space back
+                text->resize(text, offset);
+            }
+        }
+
+        if (!scallop_script_reserve((void **) &lines,
+                                    &line_capacity,
+                                    line_count,
+                                    sizeof(scallop_script_line_t)))
+        {
+            goto done;
+        }
+
+        lines[line_count].text = (uint32_t) text->size(text);
+        lines[line_count].keyword = keyword;
+        line_count++;
+
+        text->append(text, start, stop - start);
+        text->append(text, "", 1);
+    }
+
+    // Lay the parts out one after another in a single image
+    memzero(&header, sizeof(header));
+    header.magic = SCALLOP_SCRIPT_MAGIC;
+    header.version = SCALLOP_SCRIPT_VERSION;
+    header.hash = priv->hash;
+    header.source_size = priv->source_size;
+    header.keywords = (uint32_t) keyword_count;
+    header.lines = (uint32_t) line_count;
+    header.text_size = text->size(text);
+
+    priv->image_size = sizeof(header) +
+                       keyword_count * sizeof(uint32_t) +
+                       line_count * sizeof(scallop_script_line_t) +
+                       text->size(text);
+    priv->image = malloc(priv->image_size);
+    if (!priv->image)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", priv->image_size);
+        priv->image_size = 0;
+        goto done;
+    }
+
+    cursor = (char *) priv->image;
+    memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    memcpy(cursor, keywords, keyword_count * sizeof(uint32_t));
+    cursor += keyword_count * sizeof(uint32_t);
+    memcpy(cursor, lines, line_count * sizeof(scallop_script_line_t));
+    cursor += line_count * sizeof(scallop_script_line_t);
+    memcpy(cursor, text->data(text), text->size(text));
+
+    success = scallop_script_parse(priv);
+    if (!success)
+    {
+        scallop_script_unload(priv);
+    }
+
+done:
+    free(lines);
+    free(keywords);
+    if (text)
+    {
+        text->destroy(text);
+    }
+
+    return success;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_script_save(scallop_script_t * script, const char * dir)
+{
+    OBJECT_PRIV(scallop_, script);
+    bytes_t * path = NULL;
+    bytes_t * temp = NULL;
+    const char * data = (const char *) priv->image;
+    size_t remain = priv->image_size;
+    ssize_t wrote = 0;
+    bool success = false;
+    int fd = -1;
+
+    if (!priv->image)
+    {
+        return false;
+    }
+
+    // Write a private temporary, then rename it into place, so that
+    // nobody ever loads half a file.
+    path = bytes_pub.print_create("%s/%016llx%s", dir,
+                                  (unsigned long long) priv->hash,
+                                  SCALLOP_SCRIPT_EXTENSION);
+    temp = bytes_pub.print_create("%s.%ld", path->cstr(path),
+                                  (long) getpid());
+
+    fd = open(temp->cstr(temp), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        BLAMMO(WARNING, "could not create %s: %s",
+                        temp->cstr(temp), strerror(errno));
+        goto done;
+    }
+
+    while (remain > 0)
+    {
+        wrote = write(fd, data, remain);
+        if (wrote < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (wrote <= 0)
+        {
+            break;
+        }
+
+        data += wrote;
+        remain -= wrote;
+    }
+
+    success = (close(fd) == 0) && (remain == 0) &&
+              (rename(temp->cstr(temp), path->cstr(path)) == 0);
+    if (!success)
+    {
+        BLAMMO(WARNING, "could not write %s", path->cstr(path));
+        unlink(temp->cstr(temp));
+    }
+
+done:
+    temp->destroy(temp);
+    path->destroy(path);
+    return success;
+}
+
+//------------------------------------------------------------------------|
+// Dispatch a source that was read rather than mapped, as there is no file
+// left to run: a pipe can't be read twice.  Each line is copied to be
+// terminated.
+static int scallop_script_run_source(scallop_script_priv_t * priv)
+{
+    scallop_t * scallop = priv->scallop;
+    const char * line = priv->source;
+    const char * end = priv->source + priv->source_size;
+    const char * start = NULL;
+    const char * stop = NULL;
+    bytes_t * copy = bytes_pub.create(NULL, 0);
+
+    while (!scallop->quitting(scallop) &&
+           scallop_script_next(&line, end, &start, &stop))
+    {
+        copy->assign(copy, start, stop - start);
+        scallop->dispatch(scallop, copy->cstr(copy));
+        scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+    }
+
+    copy->destroy(copy);
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static int scallop_script_run(scallop_script_t * script)
+{
+    OBJECT_PRIV(scallop_, script);
+    scallop_t * scallop = priv->scallop;
+    const char * line = NULL;
+    uint32_t index = 0;
+
+    if (!priv->image && !priv->source_mapped && priv->source)
+    {
+        return scallop_script_run_source(priv);
+    }
+    else if (!priv->image)
+    {
+        return scallop->run_file(scallop, priv->path);
+    }
+
+    for (index = 0; index < priv->line_count; index++)
+    {
+        if (scallop->quitting(scallop))
+        {
+            break;
+        }
+
+        // Plain commands inside a declaration only need storing in it.
+        // Anywhere else they run, and everything else is dispatched.
+        line = &priv->text[priv->lines[index].text];
+        if (priv->lines[index].keyword != SCALLOP_SCRIPT_DISPATCH &&
+            scallop->store_line(scallop, line))
+        {
+            continue;
+        }
+
+        scallop->dispatch(scallop, line);
+
+        // As with run_file(), script lines are not inside any loop or
+        // routine.
+        scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static inline uint64_t scallop_script_hash(scallop_script_t * script)
+{
+    OBJECT_PRIV(scallop_, script);
+    return priv->hash;
+}
+
+//------------------------------------------------------------------------|
+const scallop_script_t scallop_script_pub = {
+    &scallop_script_create,
+    &scallop_script_destroy,
+    &scallop_script_load,
+    &scallop_script_compile,
+    &scallop_script_save,
+    &scallop_script_run,
+    &scallop_script_hash,
+    NULL
+};
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Compiled script format version.  Bump on any change to the layout or
+// to how lines are compiled, so that old cache files are rebuilt.
+#define SCALLOP_SCRIPT_VERSION      1
+
+// File name extension of compiled scripts in the cache directory
+#define SCALLOP_SCRIPT_EXTENSION    ".scc"
+
+//------------------------------------------------------------------------|
+// A scallop script is a source file together with its compiled form.
+// Compiling looks at each line once, ahead of time: blank and comment
+// lines are dropped, and lines starting with a plain (non-construct)
+// command keep a reference to that keyword.  When run inside a construct
+// declaration, as most of a routine body is, such lines are stored
+// straight into the declaration, as dispatch would, without being
+// looked up or tokenized.  Other lines are dispatched as usual.  The
+// keywords are interned once and checked against the registry on load.
+//
+// Compiled scripts are saved in a cache directory under the FNV-1a hash
+// of the source, so any edit to the source makes a fresh one, and are
+// memory-mapped as-is when loaded and checked line by line against the
+// source.  Lines can't be parsed any further
+// ahead of time, as their arguments are only known after substitution.
+typedef struct scallop_script_t
+{
+    // Script factory function.  Maps and hashes the source file at
+    // path, for the given scallop_t *, or reads it whole if it can't be
+    // mapped, as with a pipe.  Returns NULL if the file can't be read.
+    struct scallop_script_t * (*create)(void * scallop, const char * path);
+
+    // Script destructor function
+    void (*destroy)(void * script);
+
+    // Load the compiled form from the cache directory.  Its lines are
+    // checked against the source, so a hash collision can't run the
+    // wrong script.  Returns false if it is missing, corrupt, for a
+    // different source, or refers to a keyword that is no longer a plain
+    // command.
+    bool (*load)(struct scallop_script_t * script, const char * dir);
+
+    // Compile the source against the commands registered now.  Returns
+    // false if it is too large or memory runs out, in which case run()
+    // sources it as plain text instead.
+    bool (*compile)(struct scallop_script_t * script);
+
+    // Save the compiled form to the cache directory, replacing any there
+    // atomically.  Returns false if there is nothing compiled or the
+    // file could not be written.
+    bool (*save)(struct scallop_script_t * script, const char * dir);
+
+    // Run the script: the compiled form if there is one, otherwise the
+    // source.  Returns the same as scallop's run_file().
+    int (*run)(struct scallop_script_t * script);
+
+    // Get the FNV-1a hash of the source, which names the compiled form
+    uint64_t (*hash)(struct scallop_script_t * script);
+
+    // Private data
+    void * priv;
+}
+scallop_script_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_script_t scallop_script_pub;
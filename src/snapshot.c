@@ -0,0 +1,534 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// RayCO
+#include "utils.h"              // memzero()
+#include "chain.h"
+#include "bytes.h"
+#include "blammo.h"
+
+// Scallop
+#include "snapshot.h"
+#include "scallop.h"
+#include "command.h"
+#include "routine.h"
+#include "lines.h"
+#include "builtin.h"
+
+//------------------------------------------------------------------------|
+// "SCS1" in a native integer, which also catches images from a machine
+// of the other byte order
+#define SCALLOP_SNAPSHOT_MAGIC      0x31534353
+
+//------------------------------------------------------------------------|
+// The image is this header, then each table in the order given, then the
+// text that all of them refer to by offset, as terminated strings.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t variables;
+    uint32_t routines;
+    uint32_t lines;
+    uint32_t aliases;
+    uint64_t text_size;
+}
+scallop_snapshot_header_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t value;
+}
+scallop_snapshot_variable_t;
+
+// A routine's body is count entries of the lines table, from first
+typedef struct
+{
+    uint32_t name;
+    uint32_t first;
+    uint32_t count;
+    uint32_t pure;
+}
+scallop_snapshot_routine_t;
+
+typedef struct
+{
+    uint32_t keyword;
+    uint32_t original;
+}
+scallop_snapshot_alias_t;
+
+//------------------------------------------------------------------------|
+// Tables and text being built up for saving
+typedef struct
+{
+    scallop_t * scallop;
+    bytes_t * variables;
+    bytes_t * routines;
+    bytes_t * lines;
+    bytes_t * aliases;
+    bytes_t * text;
+}
+scallop_snapshot_save_t;
+
+//------------------------------------------------------------------------|
+// Add a terminated string to the text, returning its offset
+static uint32_t scallop_snapshot_text(bytes_t * text, const char * string)
+{
+    uint32_t offset = (uint32_t) text->size(text);
+
+    text->append(text, string, strlen(string) + 1);
+    return offset;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_snapshot_visit_alias(void * object, void * cmd_ptr)
+{
+    scallop_snapshot_save_t * save = (scallop_snapshot_save_t *) object;
+    scallop_cmd_t * cmd = (scallop_cmd_t *) cmd_ptr;
+    scallop_snapshot_alias_t alias;
+
+    if (!cmd->is_alias(cmd) || !cmd->original(cmd))
+    {
+        return;
+    }
+
+    alias.keyword = scallop_snapshot_text(save->text, cmd->keyword(cmd));
+    alias.original = scallop_snapshot_text(save->text, cmd->original(cmd));
+    save->aliases->append(save->aliases, &alias, sizeof(alias));
+}
+
+//------------------------------------------------------------------------|
+static void scallop_snapshot_build(scallop_snapshot_save_t * save)
+{
+    scallop_t * scallop = save->scallop;
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    scallop_cmd_t * cmd = NULL;
+    chain_t * routines = (chain_t *) scallop->routines(scallop);
+    scallop_rtn_t * routine = NULL;
+    scallop_lines_t * lines = NULL;
+    scallop_snapshot_variable_t variable;
+    scallop_snapshot_routine_t entry;
+    const char * name = NULL;
+    const char * value = NULL;
+    size_t cursor = 0;
+    size_t index = 0;
+    uint32_t line = 0;
+
+    while (scallop->next_variable(scallop, &cursor, &name, &value))
+    {
+        variable.name = scallop_snapshot_text(save->text, name);
+        variable.value = scallop_snapshot_text(save->text, value);
+        save->variables->append(save->variables, &variable, sizeof(variable));
+    }
+
+    // Only routines that were registered, not any still being defined
+    routine = (scallop_rtn_t *) routines->first(routines);
+    while (routine)
+    {
+        cmd = cmds->find_by_keyword(cmds, routine->name(routine));
+        if (cmd && cmd->is_mutable(cmd) && !cmd->is_alias(cmd))
+        {
+            lines = (scallop_lines_t *) routine->lines(routine);
+            entry.name = scallop_snapshot_text(save->text,
+                                               routine->name(routine));
+            entry.first = (uint32_t) (save->lines->size(save->lines) /
+                                      sizeof(uint32_t));
+            entry.count = (uint32_t) lines->count(lines);
+            entry.pure = routine->is_pure(routine);
+
+            for (index = 0; index < entry.count; index++)
+            {
+                line = scallop_snapshot_text(save->text,
+                                             lines->line(lines, index));
+                save->lines->append(save->lines, &line, sizeof(line));
+            }
+
+            save->routines->append(save->routines, &entry, sizeof(entry));
+        }
+
+        routine = (scallop_rtn_t *) routines->next(routines);
+    }
+
+    cmds->each(cmds, scallop_snapshot_visit_alias, save);
+}
+
+//------------------------------------------------------------------------|
+bool scallop_snapshot_save(void * scallop, const char * path)
+{
+    scallop_snapshot_save_t save;
+    scallop_snapshot_header_t header;
+    bytes_t * parts[5];
+    size_t index = 0;
+    bool success = false;
+    FILE * file = NULL;
+
+    save.scallop = (scallop_t *) scallop;
+    save.variables = bytes_pub.create(NULL, 0);
+    save.routines = bytes_pub.create(NULL, 0);
+    save.lines = bytes_pub.create(NULL, 0);
+    save.aliases = bytes_pub.create(NULL, 0);
+    save.text = bytes_pub.create(NULL, 0);
+    scallop_snapshot_build(&save);
+
+    memzero(&header, sizeof(header));
+    header.magic = SCALLOP_SNAPSHOT_MAGIC;
+    header.version = SCALLOP_SNAPSHOT_VERSION;
+    header.variables = (uint32_t) (save.variables->size(save.variables) /
+                                   sizeof(scallop_snapshot_variable_t));
+    header.routines = (uint32_t) (save.routines->size(save.routines) /
+                                  sizeof(scallop_snapshot_routine_t));
+    header.lines = (uint32_t) (save.lines->size(save.lines) /
+                               sizeof(uint32_t));
+    header.aliases = (uint32_t) (save.aliases->size(save.aliases) /
+                                 sizeof(scallop_snapshot_alias_t));
+    header.text_size = save.text->size(save.text);
+
+    parts[0] = save.variables;
+    parts[1] = save.routines;
+    parts[2] = save.lines;
+    parts[3] = save.aliases;
+    parts[4] = save.text;
+
+    file = fopen(path, "wb");
+    if (file)
+    {
+        success = (fwrite(&header, sizeof(header), 1, file) == 1);
+        for (index = 0; index < 5; index++)
+        {
+            if (parts[index]->size(parts[index]) > 0)
+            {
+                success &= (fwrite(parts[index]->data(parts[index]),
+                                   parts[index]->size(parts[index]),
+                                   1, file) == 1);
+            }
+        }
+
+        success &= (fclose(file) == 0);
+    }
+
+    for (index = 0; index < 5; index++)
+    {
+        parts[index]->destroy(parts[index]);
+    }
+
+    return success;
+}
+
+//------------------------------------------------------------------------|
+// Read a whole file in one go.  Returns NULL if it can't be read.
+static char * scallop_snapshot_read(const char * path, size_t * size)
+{
+    struct stat info;
+    char * image = NULL;
+    size_t done = 0;
+    ssize_t got = 0;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    *size = (size_t) info.st_size;
+    image = (char *) malloc(*size ? *size : 1);
+    if (!image)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", *size);
+        close(fd);
+        return NULL;
+    }
+
+    while (done < *size)
+    {
+        got = read(fd, &image[done], *size - done);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (got <= 0)
+        {
+            break;
+        }
+
+        done += got;
+    }
+
+    close(fd);
+    if (done < *size)
+    {
+        free(image);
+        return NULL;
+    }
+
+    return image;
+}
+
+//------------------------------------------------------------------------|
+// Check that every part of an image fits in it and every offset is in
+// the text, which must end with a terminator.
+static bool scallop_snapshot_check(const char * image, size_t size)
+{
+    const scallop_snapshot_header_t * header =
+            (const scallop_snapshot_header_t *) image;
+    const scallop_snapshot_variable_t * variables = NULL;
+    const scallop_snapshot_routine_t * routines = NULL;
+    const uint32_t * lines = NULL;
+    const scallop_snapshot_alias_t * aliases = NULL;
+    uint64_t expected = sizeof(scallop_snapshot_header_t);
+    uint64_t text_size = 0;
+    uint32_t index = 0;
+
+    if (size < expected ||
+        header->magic != SCALLOP_SNAPSHOT_MAGIC ||
+        header->version != SCALLOP_SNAPSHOT_VERSION)
+    {
+        return false;
+    }
+
+    text_size = header->text_size;
+    expected += (uint64_t) header->variables *
+                sizeof(scallop_snapshot_variable_t);
+    expected += (uint64_t) header->routines *
+                sizeof(scallop_snapshot_routine_t);
+    expected += (uint64_t) header->lines * sizeof(uint32_t);
+    expected += (uint64_t) header->aliases *
+                sizeof(scallop_snapshot_alias_t);
+    expected += text_size;
+    if (expected != size || (text_size > 0 && image[size - 1] != '\0'))
+    {
+        return false;
+    }
+
+    variables = (const scallop_snapshot_variable_t *) &header[1];
+    routines = (const scallop_snapshot_routine_t *)
+            &variables[header->variables];
+    lines = (const uint32_t *) &routines[header->routines];
+    aliases = (const scallop_snapshot_alias_t *) &lines[header->lines];
+
+    for (index = 0; index < header->variables; index++)
+    {
+        if (variables[index].name >= text_size ||
+            variables[index].value >= text_size)
+        {
+            return false;
+        }
+    }
+
+    for (index = 0; index < header->routines; index++)
+    {
+        if (routines[index].name >= text_size ||
+            routines[index].first > header->lines ||
+            routines[index].count > header->lines - routines[index].first)
+        {
+            return false;
+        }
+    }
+
+    for (index = 0; index < header->lines; index++)
+    {
+        if (lines[index] >= text_size)
+        {
+            return false;
+        }
+    }
+
+    for (index = 0; index < header->aliases; index++)
+    {
+        if (aliases[index].keyword >= text_size ||
+            aliases[index].original >= text_size)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_snapshot_routine(scallop_t * scallop,
+                                     const char * text,
+                                     const uint32_t * lines,
+                                     const scallop_snapshot_routine_t * entry)
+{
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    const char * name = &text[entry->name];
+    scallop_rtn_t * routine = NULL;
+    uint32_t index = 0;
+
+    if (scallop->routine_by_name(scallop, name) ||
+        cmds->find_by_keyword(cmds, name))
+    {
+        return false;
+    }
+
+    routine = scallop->routine_insert(scallop, name);
+    if (!routine)
+    {
+        return false;
+    }
+
+    for (index = 0; index < entry->count; index++)
+    {
+        routine->append(routine, &text[lines[entry->first + index]]);
+    }
+
+    if ((entry->pure && !routine->set_pure(routine, true)) ||
+        !register_routine_command(scallop, routine))
+    {
+        scallop->routine_remove(scallop, name);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+int scallop_snapshot_load(void * scallop_ptr, const char * path)
+{
+    scallop_t * scallop = (scallop_t *) scallop_ptr;
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    scallop_cmd_t * cmd = NULL;
+    scallop_cmd_t * alias = NULL;
+    const scallop_snapshot_header_t * header = NULL;
+    const scallop_snapshot_variable_t * variables = NULL;
+    const scallop_snapshot_routine_t * routines = NULL;
+    const uint32_t * lines = NULL;
+    const scallop_snapshot_alias_t * aliases = NULL;
+    const char * text = NULL;
+    bool * restored = NULL;
+    bool progress = true;
+    size_t size = 0;
+    uint32_t index = 0;
+    int failed = 0;
+    char * image = scallop_snapshot_read(path, &size);
+
+    if (!image)
+    {
+        return -1;
+    }
+
+    if (!scallop_snapshot_check(image, size))
+    {
+        free(image);
+        return -1;
+    }
+
+    // The image is used where it lies.  Everything below copies out of
+    // it, so it can go as soon as this is done.
+    header = (const scallop_snapshot_header_t *) image;
+    variables = (const scallop_snapshot_variable_t *) &header[1];
+    routines = (const scallop_snapshot_routine_t *)
+            &variables[header->variables];
+    lines = (const uint32_t *) &routines[header->routines];
+    aliases = (const scallop_snapshot_alias_t *) &lines[header->lines];
+    text = (const char *) &aliases[header->aliases];
+
+    for (index = 0; index < header->variables; index++)
+    {
+        scallop->assign_variable(scallop,
+                                 &text[variables[index].name],
+                                 &text[variables[index].value]);
+    }
+
+    for (index = 0; index < header->routines; index++)
+    {
+        if (!scallop_snapshot_routine(scallop, text, lines, &routines[index]))
+        {
+            BLAMMO(WARNING, "routine %s not restored",
+                            &text[routines[index].name]);
+            failed++;
+        }
+    }
+
+    // Aliases may be of other aliases, in whatever order they come, so
+    // keep going around until no more can be made.
+    restored = (bool *) calloc(header->aliases + 1, sizeof(bool));
+    if (!restored)
+    {
+        BLAMMO(FATAL, "calloc(%u) failed", header->aliases + 1);
+        free(image);
+        return -1;
+    }
+
+    while (progress)
+    {
+        progress = false;
+        for (index = 0; index < header->aliases; index++)
+        {
+            if (restored[index] ||
+                cmds->find_by_keyword(cmds, &text[aliases[index].keyword]))
+            {
+                continue;
+            }
+
+            cmd = cmds->find_by_keyword(cmds, &text[aliases[index].original]);
+            if (!cmd)
+            {
+                continue;
+            }
+
+            alias = cmds->alias(cmd, &text[aliases[index].keyword]);
+            if (!cmds->register_cmd(cmds, alias))
+            {
+                alias->destroy(alias);
+                continue;
+            }
+
+            restored[index] = true;
+            progress = true;
+        }
+    }
+
+    for (index = 0; index < header->aliases; index++)
+    {
+        if (!restored[index])
+        {
+            BLAMMO(WARNING, "alias %s not restored",
+                            &text[aliases[index].keyword]);
+            failed++;
+        }
+    }
+
+    free(restored);
+    free(image);
+    return failed;
+}
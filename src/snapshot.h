@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Snapshot image format version.  Bump on any change to the layout.
+#define SCALLOP_SNAPSHOT_VERSION    1
+
+//------------------------------------------------------------------------|
+// A snapshot is a compact binary image of the state a session builds up
+// while warming up: assigned variables, routines with their bodies, and
+// aliases.  Everything refers by offset into one block of text, so an
+// image is read back in a single read and used where it lies.  Routine
+// arguments, results, list and map variables, and profiling data are
+// not included.
+
+// Save the state of a scallop_t * to a file.  Returns false if the file
+// could not be written.
+bool scallop_snapshot_save(void * scallop, const char * path);
+
+// Restore the state saved in a file into a scallop_t *.  Variables are
+// assigned over any by the same name, but routines and aliases are not
+// allowed to replace existing commands.  Returns the number of routines
+// and aliases that could not be restored, or -1 if the file could not
+// be read or is not a valid snapshot.
+int scallop_snapshot_load(void * scallop, const char * path);
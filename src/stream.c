@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "stream.h"
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Memory stream being written, until the first read
+    FILE * writer;
+
+    // Everything written, as grown by the memory stream, and its size
+    char * buffer;
+    size_t size;
+
+    // Where the next line to be read starts
+    size_t cursor;
+}
+scallop_stream_priv_t;
+
+//------------------------------------------------------------------------|
+static scallop_stream_t * scallop_stream_create()
+{
+    OBJECT_ALLOC(scallop_, stream);
+
+    priv->writer = open_memstream(&priv->buffer, &priv->size);
+    if (!priv->writer)
+    {
+        BLAMMO(FATAL, "open_memstream() failed");
+        stream->destroy(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_stream_destroy(void * stream_ptr)
+{
+    OBJECT_PTR(scallop_, stream, stream_ptr, );
+
+    if (priv->writer)
+    {
+        fclose(priv->writer);
+    }
+
+    free(priv->buffer);
+    OBJECT_FREE(scallop_, stream);
+}
+
+//------------------------------------------------------------------------|
+static inline FILE * scallop_stream_writer(scallop_stream_t * stream)
+{
+    OBJECT_PRIV(scallop_, stream);
+    return priv->writer;
+}
+
+//------------------------------------------------------------------------|
+static const char * scallop_stream_read_line(scallop_stream_t * stream)
+{
+    OBJECT_PRIV(scallop_, stream);
+    char * line = NULL;
+    char * newline = NULL;
+
+    // Closing the memory stream settles the buffer and its size
+    if (priv->writer)
+    {
+        fclose(priv->writer);
+        priv->writer = NULL;
+    }
+
+    if (!priv->buffer || priv->cursor >= priv->size)
+    {
+        return NULL;
+    }
+
+    line = &priv->buffer[priv->cursor];
+    newline = (char *) memchr(line, '\n', priv->size - priv->cursor);
+    if (newline)
+    {
+        *newline = '\0';
+        priv->cursor = newline - priv->buffer + 1;
+    }
+    else
+    {
+        // The memory stream always keeps a terminator after the end
+        newline = &priv->buffer[priv->size];
+        priv->cursor = priv->size;
+    }
+
+    if (newline > line && newline[-1] == '\r')
+    {
+        newline[-1] = '\0';
+    }
+
+    return line;
+}
+
+//------------------------------------------------------------------------|
+static size_t scallop_stream_size(scallop_stream_t * stream)
+{
+    OBJECT_PRIV(scallop_, stream);
+
+    if (priv->writer)
+    {
+        fflush(priv->writer);
+    }
+
+    return priv->size;
+}
+
+//------------------------------------------------------------------------|
+const scallop_stream_t scallop_stream_pub = {
+    &scallop_stream_create,
+    &scallop_stream_destroy,
+    &scallop_stream_writer,
+    &scallop_stream_read_line,
+    &scallop_stream_size,
+    NULL
+};
@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop stream carries the output of one command in a pipeline to
+// the next as its input.  It is written through a FILE *, which is
+// handed to the console as its output while the first command runs, and
+// then read back a line at a time by the second, straight from memory.
+// Writing ends with the first read.
+typedef struct scallop_stream_t
+{
+    // Stream factory function
+    struct scallop_stream_t * (*create)();
+
+    // Stream destructor function
+    void (*destroy)(void * stream);
+
+    // Get the FILE * that writes into the stream, or NULL once reading
+    // has begun
+    FILE * (*writer)(struct scallop_stream_t * stream);
+
+    // Get the next line written, without its line ending, or NULL when
+    // there are no more.  Lines are terminated in place, and stay valid
+    // until the stream is destroyed.
+    const char * (*read_line)(struct scallop_stream_t * stream);
+
+    // Get the number of bytes written so far
+    size_t (*size)(struct scallop_stream_t * stream);
+
+    // Private data
+    void * priv;
+}
+scallop_stream_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_stream_t scallop_stream_pub;
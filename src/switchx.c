@@ -0,0 +1,396 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+#include "console.h"
+#include "bytes.h"
+
+// Scallop
+#include "scallop.h"
+#include "command.h"
+#include "lines.h"
+#include "switchx.h"
+
+//------------------------------------------------------------------------|
+// Marks an unused slot in the label table
+#define SCALLOP_SWITCHX_NONE    ((size_t) -1)
+
+// Smallest label table allocated.  Must be a power of two.
+#define SCALLOP_SWITCHX_SLOTS   16
+
+//------------------------------------------------------------------------|
+// One slot of the open-addressed label table, mapping a case label to
+// the index of its arm
+typedef struct
+{
+    long label;
+    size_t arm;
+}
+scallop_switchx_slot_t;
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // The raw unevaluated expression selecting an arm
+    bytes_t * expression;
+
+    // Raw command lines of each 'case' arm, in order of declaration
+    scallop_lines_t ** arms;
+    size_t narms;
+    size_t arms_capacity;
+
+    // Raw command lines of the 'else' arm, if any
+    scallop_lines_t * default_lines;
+
+    // which arm is being added to, NULL before the first 'case'
+    scallop_lines_t * lines;
+
+    // Whether any lines came before the first 'case'
+    bool stray;
+
+    // Whether lines are dropped, after an arm was closed
+    bool closed;
+
+    // Label table, linear probing, kept at most half full
+    scallop_switchx_slot_t * slots;
+    size_t nslots;
+    size_t nlabels;
+}
+scallop_switchx_priv_t;
+
+//------------------------------------------------------------------------|
+// Fibonacci hashing spreads out runs of consecutive labels
+static inline size_t scallop_switchx_hash(long label, size_t nslots)
+{
+    uint64_t hash = (uint64_t) label * 11400714819323198485ull;
+    return (size_t) (hash ^ (hash >> 32)) & (nslots - 1);
+}
+
+//------------------------------------------------------------------------|
+// Find the slot for a label: either the one holding it, or the empty
+// slot where it belongs.
+static scallop_switchx_slot_t * scallop_switchx_slot(scallop_switchx_slot_t * slots,
+                                                     size_t nslots,
+                                                     long label)
+{
+    size_t index = scallop_switchx_hash(label, nslots);
+
+    while (slots[index].arm != SCALLOP_SWITCHX_NONE &&
+           slots[index].label != label)
+    {
+        index = (index + 1) & (nslots - 1);
+    }
+
+    return &slots[index];
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_rehash(scallop_switchx_priv_t * priv,
+                                   size_t nslots)
+{
+    scallop_switchx_slot_t * slots = NULL;
+    scallop_switchx_slot_t * slot = NULL;
+    size_t index = 0;
+
+    slots = (scallop_switchx_slot_t *) malloc(nslots * sizeof(*slots));
+    if (!slots)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", nslots * sizeof(*slots));
+        return false;
+    }
+
+    for (index = 0; index < nslots; index++)
+    {
+        slots[index].arm = SCALLOP_SWITCHX_NONE;
+    }
+
+    for (index = 0; index < priv->nslots; index++)
+    {
+        if (priv->slots[index].arm != SCALLOP_SWITCHX_NONE)
+        {
+            slot = scallop_switchx_slot(slots,
+                                        nslots,
+                                        priv->slots[index].label);
+            *slot = priv->slots[index];
+        }
+    }
+
+    free(priv->slots);
+    priv->slots = slots;
+    priv->nslots = nslots;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static scallop_switchx_t * scallop_switchx_create(const char * expression)
+{
+    OBJECT_ALLOC(scallop_, switchx);
+
+    priv->expression = bytes_pub.create(expression, strlen(expression));
+    if (!priv->expression)
+    {
+        BLAMMO(FATAL, "bytes_pub.create(%s) failed", expression);
+        switchx->destroy(switchx);
+        return NULL;
+    }
+
+    if (!scallop_switchx_rehash(priv, SCALLOP_SWITCHX_SLOTS))
+    {
+        switchx->destroy(switchx);
+        return NULL;
+    }
+
+    return switchx;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_switchx_destroy(void * switchx_ptr)
+{
+    OBJECT_PTR(scallop_, switchx, switchx_ptr, );
+    size_t index = 0;
+
+    free(priv->slots);
+
+    if (priv->default_lines)
+    {
+        priv->default_lines->destroy(priv->default_lines);
+    }
+
+    for (index = 0; index < priv->narms; index++)
+    {
+        priv->arms[index]->destroy(priv->arms[index]);
+    }
+
+    free(priv->arms);
+
+    if (priv->expression)
+    {
+        priv->expression->destroy(priv->expression);
+    }
+
+    OBJECT_FREE(scallop_, switchx);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_new_arm(scallop_switchx_t * switchx)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    scallop_lines_t ** arms = NULL;
+    size_t capacity = 0;
+
+    // Arms following the default arm could never be reached
+    if (priv->default_lines)
+    {
+        return false;
+    }
+
+    if (priv->narms == priv->arms_capacity)
+    {
+        capacity = priv->arms_capacity ? 2 * priv->arms_capacity : 8;
+        arms = (scallop_lines_t **) realloc(priv->arms,
+                                            capacity * sizeof(*arms));
+        if (!arms)
+        {
+            BLAMMO(FATAL, "realloc(%zu) failed", capacity * sizeof(*arms));
+            return false;
+        }
+
+        priv->arms = arms;
+        priv->arms_capacity = capacity;
+    }
+
+    priv->lines = scallop_lines_pub.create();
+    if (!priv->lines)
+    {
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
+        return false;
+    }
+
+    priv->arms[priv->narms++] = priv->lines;
+    priv->closed = false;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_add_label(scallop_switchx_t * switchx,
+                                      long label)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    scallop_switchx_slot_t * slot = NULL;
+
+    // Labels only belong to 'case' arms
+    if (priv->narms == 0 || priv->lines != priv->arms[priv->narms - 1])
+    {
+        return false;
+    }
+
+    // Keep the table at most half full so probe runs stay short
+    if (2 * (priv->nlabels + 1) > priv->nslots &&
+        !scallop_switchx_rehash(priv, 2 * priv->nslots))
+    {
+        return false;
+    }
+
+    slot = scallop_switchx_slot(priv->slots, priv->nslots, label);
+    if (slot->arm != SCALLOP_SWITCHX_NONE)
+    {
+        BLAMMO(WARNING, "duplicate case label %ld", label);
+        return false;
+    }
+
+    slot->label = label;
+    slot->arm = priv->narms - 1;
+    priv->nlabels++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_switchx_close_arm(scallop_switchx_t * switchx)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    priv->closed = true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_has_label(scallop_switchx_t * switchx,
+                                      long label)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    scallop_switchx_slot_t * slot = NULL;
+
+    slot = scallop_switchx_slot(priv->slots, priv->nslots, label);
+    return slot->arm != SCALLOP_SWITCHX_NONE;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_has_default(scallop_switchx_t * switchx)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    return priv->default_lines != NULL;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_switchx_default_arm(scallop_switchx_t * switchx)
+{
+    OBJECT_PRIV(scallop_, switchx);
+
+    if (priv->default_lines)
+    {
+        return false;
+    }
+
+    priv->default_lines = scallop_lines_pub.create();
+    if (!priv->default_lines)
+    {
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
+        return false;
+    }
+
+    priv->lines = priv->default_lines;
+    priv->closed = false;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_switchx_append(scallop_switchx_t * switchx,
+                                   const char * line)
+{
+    OBJECT_PRIV(scallop_, switchx);
+
+    // Lines of a rejected 'case' belong to no arm
+    if (priv->closed)
+    {
+        return;
+    }
+
+    // Nothing can select lines ahead of the first arm.  Remember them
+    // so the runner can complain rather than silently drop them.
+    if (!priv->lines)
+    {
+        priv->stray = true;
+        return;
+    }
+
+    priv->lines->append(priv->lines, line);
+}
+
+//------------------------------------------------------------------------|
+static int scallop_switchx_runner(scallop_switchx_t * switchx,
+                                  void * context)
+{
+    OBJECT_PRIV(scallop_, switchx);
+    scallop_t * scallop = (scallop_t *) context;
+    console_t * console = scallop->console(scallop);
+    scallop_switchx_slot_t * slot = NULL;
+    long value = 0;
+
+    if (priv->stray)
+    {
+        console->error(console, "switch has lines before the first case");
+        return ERROR_MARKER_DEC;
+    }
+
+    if (!scallop->evaluate_value(scallop,
+                                 priv->expression->cstr(priv->expression),
+                                 priv->expression->size(priv->expression),
+                                 &value))
+    {
+        return ERROR_MARKER_DEC;
+    }
+
+    slot = scallop_switchx_slot(priv->slots, priv->nslots, value);
+    if (slot->arm != SCALLOP_SWITCHX_NONE)
+    {
+        return scallop->run_lines(scallop, priv->arms[slot->arm]);
+    }
+
+    if (priv->default_lines)
+    {
+        return scallop->run_lines(scallop, priv->default_lines);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+const scallop_switchx_t scallop_switchx_pub = {
+    &scallop_switchx_create,
+    &scallop_switchx_destroy,
+    &scallop_switchx_new_arm,
+    &scallop_switchx_add_label,
+    &scallop_switchx_close_arm,
+    &scallop_switchx_has_label,
+    &scallop_switchx_has_default,
+    &scallop_switchx_default_arm,
+    &scallop_switchx_append,
+    &scallop_switchx_runner,
+    NULL
+};
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A scallop switch selects one of several arms by the numeric value of a
+// single expression.  Each 'case' modifier starts a new arm with one or
+// more integer labels, and 'else' starts the default arm.  Labels are
+// hashed as they are declared, so selecting an arm costs one evaluation
+// and one lookup no matter how many arms there are.  Arms do not fall
+// through.  Like if-else, switches are short-lived and are destroyed once
+// run on stack pop.
+typedef struct scallop_switchx_t
+{
+    // Switch factory function
+    struct scallop_switchx_t * (*create)(const char * expression);
+
+    // Switch destructor function
+    void (*destroy)(void * switchx);
+
+    // Start a new arm.  Following lines are appended to it.  Returns
+    // false once the default arm has been started, which must be last.
+    bool (*new_arm)(struct scallop_switchx_t * switchx);
+
+    // Add a label selecting the current arm.  Returns false if there is
+    // no current arm or the label is already used by another.
+    bool (*add_label)(struct scallop_switchx_t * switchx, long label);
+
+    // Stop appending to the current arm.  Lines are dropped until the
+    // next arm is started.
+    void (*close_arm)(struct scallop_switchx_t * switchx);
+
+    // Whether a label already selects some arm
+    bool (*has_label)(struct scallop_switchx_t * switchx, long label);
+
+    // Whether the default arm has been started
+    bool (*has_default)(struct scallop_switchx_t * switchx);
+
+    // Start the default arm, run when no label matches.  Returns false
+    // if there already is one.
+    bool (*default_arm)(struct scallop_switchx_t * switchx);
+
+    // Append a line to the current arm
+    void (*append)(struct scallop_switchx_t * switchx, const char * line);
+
+    // Run the arm matching the evaluated expression
+    int (*runner)(struct scallop_switchx_t * switchx, void * context);
+
+    // Private data
+    void * priv;
+}
+scallop_switchx_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_switchx_t scallop_switchx_pub;
@@ -0,0 +1,302 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "trace.h"
+#include "clock.h"
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    uint64_t ns;
+    const char * category;
+    uint32_t depth;
+    char phase;
+    char track;
+    char name[SCALLOP_TRACE_NAME_SIZE];
+}
+scallop_trace_event_t;
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // Ring buffer of events.  head is where the next one goes.
+    scallop_trace_event_t * events;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    size_t dropped;
+
+    // Timestamp that the timeline starts from
+    uint64_t start_ns;
+}
+scallop_trace_priv_t;
+
+//------------------------------------------------------------------------|
+static scallop_trace_t * scallop_trace_create(size_t capacity)
+{
+    OBJECT_ALLOC(scallop_, trace);
+
+    priv->capacity = capacity ? capacity : SCALLOP_TRACE_EVENTS;
+    priv->events = (scallop_trace_event_t *)
+            calloc(priv->capacity, sizeof(scallop_trace_event_t));
+    if (!priv->events)
+    {
+        BLAMMO(FATAL, "calloc(%zu) events failed", priv->capacity);
+        trace->destroy(trace);
+        return NULL;
+    }
+
+    trace->clear(trace);
+    return trace;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_trace_destroy(void * trace_ptr)
+{
+    OBJECT_PTR(scallop_, trace, trace_ptr, );
+
+    if (priv->events)
+    {
+        free(priv->events);
+    }
+
+    OBJECT_FREE(scallop_, trace);
+}
+
+//------------------------------------------------------------------------|
+static void scallop_trace_clear(scallop_trace_t * trace)
+{
+    OBJECT_PRIV(scallop_, trace);
+
+    priv->head = 0;
+    priv->count = 0;
+    priv->dropped = 0;
+    priv->start_ns = scallop_clock_ns();
+}
+
+//------------------------------------------------------------------------|
+static void scallop_trace_record(scallop_trace_t * trace,
+                                 char phase,
+                                 scallop_trace_track_t track,
+                                 const char * category,
+                                 const char * name,
+                                 size_t size,
+                                 size_t depth)
+{
+    OBJECT_PRIV(scallop_, trace);
+    scallop_trace_event_t * event = &priv->events[priv->head];
+    size_t length = 0;
+
+    event->ns = scallop_clock_ns();
+    event->category = category;
+    event->depth = (uint32_t) depth;
+    event->phase = phase;
+    event->track = (char) track;
+    if (name)
+    {
+        length = strnlen(name, size < SCALLOP_TRACE_NAME_SIZE ?
+                               size : SCALLOP_TRACE_NAME_SIZE - 1);
+        memcpy(event->name, name, length);
+    }
+
+    event->name[length] = '\0';
+
+    priv->head = (priv->head + 1) % priv->capacity;
+    if (priv->count < priv->capacity)
+    {
+        priv->count++;
+    }
+    else
+    {
+        priv->dropped++;
+    }
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_trace_count(scallop_trace_t * trace)
+{
+    OBJECT_PRIV(scallop_, trace);
+    return priv->count;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_trace_dropped(scallop_trace_t * trace)
+{
+    OBJECT_PRIV(scallop_, trace);
+    return priv->dropped;
+}
+
+//------------------------------------------------------------------------|
+// Write a name as a JSON string body, escaping as needed
+static void scallop_trace_escape(FILE * file, const char * name)
+{
+    const unsigned char * c = (const unsigned char *) name;
+
+    for (; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fprintf(file, "\\%c", *c);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+}
+
+//------------------------------------------------------------------------|
+// Write one event, separated from any before it
+static void scallop_trace_write(FILE * file,
+                                scallop_trace_priv_t * priv,
+                                const scallop_trace_event_t * event,
+                                char phase,
+                                uint64_t ns,
+                                bool first)
+{
+    // Timestamps are in microseconds, kept to the nanosecond
+    fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+    scallop_trace_escape(file, phase == event->phase ? event->name : "");
+    fprintf(file,
+            "\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+            "\"pid\":1,\"tid\":%d,\"args\":{\"depth\":%u}}",
+            event->category,
+            phase,
+            (ns - priv->start_ns) / 1e3,
+            event->track,
+            event->depth);
+}
+
+//------------------------------------------------------------------------|
+// Events are written balanced on each track: an end whose begin has been
+// overwritten is left out, and anything still open when dumped, such as
+// the dispatch doing the dumping, is closed at the time of the dump.
+static bool scallop_trace_dump(scallop_trace_t * trace, const char * path)
+{
+    OBJECT_PRIV(scallop_, trace);
+    scallop_trace_event_t * event = NULL;
+    size_t oldest = (priv->head + priv->capacity - priv->count) %
+                    priv->capacity;
+    size_t open[SCALLOP_TRACE_TRACK_CONSTRUCT + 1] = { 0 };
+    size_t ended[SCALLOP_TRACE_TRACK_CONSTRUCT + 1] = { 0 };
+    uint64_t now_ns = scallop_clock_ns();
+    size_t index = 0;
+    bool first = true;
+    bool success = true;
+
+    FILE * file = fopen(path, "w");
+    if (!file)
+    {
+        BLAMMO(ERROR, "fopen(%s) failed", path);
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (index = 0; index < priv->count; index++)
+    {
+        event = &priv->events[(oldest + index) % priv->capacity];
+        if (event->phase == 'B')
+        {
+            open[(size_t) event->track]++;
+        }
+        else if (open[(size_t) event->track] > 0)
+        {
+            open[(size_t) event->track]--;
+        }
+        else
+        {
+            continue;
+        }
+
+        scallop_trace_write(file, priv, event, event->phase, event->ns, first);
+        first = false;
+    }
+
+    // Close whatever is still open, innermost first, by walking back from
+    // the newest event.  A begin with no end after it at its own level is
+    // one that's still open.
+    for (index = priv->count; index > 0; index--)
+    {
+        event = &priv->events[(oldest + index - 1) % priv->capacity];
+        if (open[(size_t) event->track] == 0)
+        {
+            continue;
+        }
+        else if (event->phase == 'E')
+        {
+            ended[(size_t) event->track]++;
+        }
+        else if (ended[(size_t) event->track] > 0)
+        {
+            ended[(size_t) event->track]--;
+        }
+        else
+        {
+            open[(size_t) event->track]--;
+            scallop_trace_write(file, priv, event, 'E', now_ns, first);
+            first = false;
+        }
+    }
+
+    fprintf(file, "%s],\"displayTimeUnit\":\"ns\"}\n", first ? "" : "\n");
+
+    if (ferror(file))
+    {
+        BLAMMO(ERROR, "error writing %s", path);
+        success = false;
+    }
+
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+
+    return success;
+}
+
+//------------------------------------------------------------------------|
+const scallop_trace_t scallop_trace_pub = {
+    &scallop_trace_create,
+    &scallop_trace_destroy,
+    &scallop_trace_clear,
+    &scallop_trace_record,
+    &scallop_trace_count,
+    &scallop_trace_dropped,
+    &scallop_trace_dump,
+    NULL
+};
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Default number of events held when no capacity is given
+#define SCALLOP_TRACE_EVENTS      65536
+
+// Longest event name kept, including the terminator.  Longer names,
+// such as whole dispatched lines, are truncated.
+#define SCALLOP_TRACE_NAME_SIZE   48
+
+// Separate timeline tracks.  Construct declarations span several
+// dispatches, so they would not nest properly on the dispatch track.
+typedef enum
+{
+    SCALLOP_TRACE_TRACK_DISPATCH = 1,
+    SCALLOP_TRACE_TRACK_CONSTRUCT
+}
+scallop_trace_track_t;
+
+//------------------------------------------------------------------------|
+// A scallop trace records timestamped begin and end events into a ring
+// buffer allocated up front, so recording never allocates or blocks.
+// Once full, the oldest events are overwritten.  The buffer can be
+// written out in the Chrome trace-event JSON format, for viewing in
+// chrome://tracing or Perfetto.
+typedef struct scallop_trace_t
+{
+    // Trace factory function, holding at most capacity events
+    struct scallop_trace_t * (*create)(size_t capacity);
+
+    // Trace destructor function
+    void (*destroy)(void * trace);
+
+    // Discard all events, and restart the timeline at zero
+    void (*clear)(struct scallop_trace_t * trace);
+
+    // Record a begin ('B') or end ('E') event.  category must be a
+    // string literal since only the pointer is kept.  At most size bytes
+    // of name are copied, stopping early at a terminator, so SIZE_MAX
+    // works for any terminated name.  name may be NULL, as is typical
+    // for end events.
+    void (*record)(struct scallop_trace_t * trace,
+                   char phase,
+                   scallop_trace_track_t track,
+                   const char * category,
+                   const char * name,
+                   size_t size,
+                   size_t depth);
+
+    // Get the number of events held
+    size_t (*count)(struct scallop_trace_t * trace);
+
+    // Get the number of events overwritten since the last clear
+    size_t (*dropped)(struct scallop_trace_t * trace);
+
+    // Write all events held, oldest first, as trace-event JSON.  Ends
+    // whose begins were overwritten are left out, and begins still open
+    // are closed at the time of the dump.  Returns false if the file
+    // could not be written.
+    bool (*dump)(struct scallop_trace_t * trace, const char * path);
+
+    // Private data
+    void * priv;
+}
+scallop_trace_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_trace_t scallop_trace_pub;
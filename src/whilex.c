@@ -31,12 +31,12 @@
 #include "utils.h"              // memzero(), OBJECT macros
 #include "blammo.h"
 #include "console.h"
-#include "chain.h"
 #include "bytes.h"
 
 // Scallop
 #include "scallop.h"
 #include "command.h"
+#include "lines.h"
 #include "whilex.h"
 
 //------------------------------------------------------------------------|
@@ -46,7 +46,7 @@ typedef struct
     bytes_t * condition;
 
     // Raw command lines consisting of the while body
-    chain_t * lines;
+    scallop_lines_t * lines;
 }
 scallop_whilex_priv_t;
 
@@ -68,11 +68,10 @@ static scallop_whilex_t * scallop_whilex_create(const char * condition)
     // List of raw (mostly) uninterpreted command lines consisting
     // of the body of the whilex.  One exception to this is we'll
     // need to track the nested depth of an 'end' keyword (multi-use)
-    priv->lines = chain_pub.create(bytes_pub.copy,
-                                   bytes_pub.destroy);
+    priv->lines = scallop_lines_pub.create();
     if (!priv->lines)
     {
-        BLAMMO(FATAL, "chain_pub.create() failed");
+        BLAMMO(FATAL, "scallop_lines_pub.create() failed");
         whilex->destroy(whilex);
         return NULL;
     }
@@ -102,16 +101,7 @@ static void scallop_whilex_destroy(void * whilex_ptr)
 static void scallop_whilex_append(scallop_whilex_t * whilex, const char * line)
 {
     OBJECT_PRIV(scallop_, whilex);
-
-    // First create the line object
-    bytes_t * linebytes = bytes_pub.create(line, strlen(line));
-
-    // Make no assumptions about the state of the chain, but always
-    // force the insert at the 'end' of the chain, which is always at -1
-    // since the chain is circular.
-    priv->lines->reset(priv->lines);
-    priv->lines->spin(priv->lines, -1);
-    priv->lines->insert(priv->lines, linebytes);
+    priv->lines->append(priv->lines, line);
 }
 
 //------------------------------------------------------------------------|
@@ -129,6 +119,25 @@ static int scallop_whilex_runner(scallop_whilex_t * whilex,
     {
         // Iterate through all lines and dispatch each
         result = scallop->run_lines(scallop, priv->lines);
+
+        // Consume 'break' and 'continue' meant for this loop, but
+        // leave 'return' pending for the enclosing routine.
+        switch (scallop->unwinding(scallop))
+        {
+            case SCALLOP_UNWIND_CONTINUE:
+                scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+                continue;
+
+            case SCALLOP_UNWIND_BREAK:
+                scallop->unwind(scallop, SCALLOP_UNWIND_NONE);
+                return result;
+
+            case SCALLOP_UNWIND_RETURN:
+                return result;
+
+            default:
+                break;
+        }
     }
 
     return result;
@@ -0,0 +1,278 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+// RayCO
+#include "utils.h"              // memzero(), OBJECT macros
+#include "blammo.h"
+
+// Scallop
+#include "writer.h"
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // The file written, and how each record is written to it
+    FILE * file;
+    scallop_writer_format_f format;
+    scallop_writer_policy_t policy;
+
+    // Queue storage: capacity records of record_size bytes each
+    unsigned char * records;
+    size_t record_size;
+    size_t capacity;
+
+    // Records pushed, and records written.  Both only ever increase, so
+    // their difference is how many are queued.  Only the pushing thread
+    // stores to head, and only the writer thread stores to tail.
+    atomic_size_t head;
+    atomic_size_t tail;
+
+    // Set by the writer thread while it waits on wake for more records,
+    // so that pushing only posts to wake when it must.
+    atomic_bool idle;
+    atomic_bool stopping;
+    atomic_bool failed;
+    sem_t wake;
+
+    // Records written and flushed to the file, under lock.  done is
+    // signaled whenever this or tail moves, for flush() and for push()
+    // waiting on room.
+    size_t flushed;
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+
+    // Records dropped, counted by the pushing thread alone
+    size_t dropped;
+
+    pthread_t thread;
+    bool running;
+}
+scallop_writer_priv_t;
+
+//------------------------------------------------------------------------|
+// Write out records as they are queued, flushing the file whenever the
+// queue runs dry, until asked to stop with nothing left.
+static void * scallop_writer_thread(void * writer_ptr)
+{
+    scallop_writer_t * writer = (scallop_writer_t *) writer_ptr;
+    OBJECT_PRIV(scallop_, writer);
+    size_t tail = atomic_load(&priv->tail);
+    size_t head = 0;
+    bool written = false;
+
+    while (true)
+    {
+        head = atomic_load(&priv->head);
+        while (tail != head)
+        {
+            priv->format(priv->file, &priv->records[(tail % priv->capacity) *
+                                                    priv->record_size]);
+            atomic_store(&priv->tail, ++tail);
+            written = true;
+        }
+
+        if (written && (fflush(priv->file) != 0 || ferror(priv->file)))
+        {
+            atomic_store(&priv->failed, true);
+        }
+
+        written = false;
+        pthread_mutex_lock(&priv->lock);
+        priv->flushed = tail;
+        pthread_cond_broadcast(&priv->done);
+        pthread_mutex_unlock(&priv->lock);
+
+        if (atomic_load(&priv->stopping) && atomic_load(&priv->head) == tail)
+        {
+            break;
+        }
+
+        // Look again after saying so, in case a record came in between
+        atomic_store(&priv->idle, true);
+        if (atomic_load(&priv->head) == tail && !atomic_load(&priv->stopping))
+        {
+            sem_wait(&priv->wake);
+        }
+        atomic_store(&priv->idle, false);
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------|
+static scallop_writer_t * scallop_writer_create(const char * path,
+                                                bool append,
+                                                size_t record_size,
+                                                size_t capacity,
+                                                scallop_writer_format_f format,
+                                                scallop_writer_policy_t policy)
+{
+    if (!path || !record_size || !capacity || !format)
+    {
+        BLAMMO(ERROR, "invalid writer parameters");
+        return NULL;
+    }
+
+    OBJECT_ALLOC(scallop_, writer);
+
+    priv->format = format;
+    priv->policy = policy;
+    priv->record_size = record_size;
+    priv->capacity = capacity;
+    atomic_init(&priv->head, 0);
+    atomic_init(&priv->tail, 0);
+    atomic_init(&priv->idle, false);
+    atomic_init(&priv->stopping, false);
+    atomic_init(&priv->failed, false);
+    sem_init(&priv->wake, 0, 0);
+    pthread_mutex_init(&priv->lock, NULL);
+    pthread_cond_init(&priv->done, NULL);
+
+    priv->records = (unsigned char *) malloc(record_size * capacity);
+    if (!priv->records)
+    {
+        BLAMMO(FATAL, "malloc(%zu) failed", record_size * capacity);
+        writer->destroy(writer);
+        return NULL;
+    }
+
+    priv->file = fopen(path, append ? "a" : "w");
+    if (!priv->file)
+    {
+        BLAMMO(ERROR, "could not open %s for writing", path);
+        writer->destroy(writer);
+        return NULL;
+    }
+
+    if (pthread_create(&priv->thread, NULL, scallop_writer_thread, writer) != 0)
+    {
+        BLAMMO(ERROR, "pthread_create() failed");
+        writer->destroy(writer);
+        return NULL;
+    }
+
+    priv->running = true;
+    return writer;
+}
+
+//------------------------------------------------------------------------|
+static void scallop_writer_destroy(void * writer_ptr)
+{
+    OBJECT_PTR(scallop_, writer, writer_ptr, );
+
+    if (priv->running)
+    {
+        atomic_store(&priv->stopping, true);
+        sem_post(&priv->wake);
+        pthread_join(priv->thread, NULL);
+    }
+
+    if (priv->file)
+    {
+        fclose(priv->file);
+    }
+
+    pthread_cond_destroy(&priv->done);
+    pthread_mutex_destroy(&priv->lock);
+    sem_destroy(&priv->wake);
+    free(priv->records);
+    OBJECT_FREE(scallop_, writer);
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_writer_push(scallop_writer_t * writer, const void * record)
+{
+    OBJECT_PRIV(scallop_, writer);
+    size_t head = atomic_load_explicit(&priv->head, memory_order_relaxed);
+
+    if (head - atomic_load(&priv->tail) >= priv->capacity)
+    {
+        if (priv->policy == SCALLOP_WRITER_DROP)
+        {
+            priv->dropped++;
+            return false;
+        }
+
+        pthread_mutex_lock(&priv->lock);
+        while (head - atomic_load(&priv->tail) >= priv->capacity)
+        {
+            pthread_cond_wait(&priv->done, &priv->lock);
+        }
+        pthread_mutex_unlock(&priv->lock);
+    }
+
+    memcpy(&priv->records[(head % priv->capacity) * priv->record_size],
+           record,
+           priv->record_size);
+    atomic_store(&priv->head, head + 1);
+
+    if (atomic_load(&priv->idle))
+    {
+        sem_post(&priv->wake);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool scallop_writer_flush(scallop_writer_t * writer)
+{
+    OBJECT_PRIV(scallop_, writer);
+    size_t head = atomic_load(&priv->head);
+
+    // Whatever was pushed has already woken the writer thread if need be
+    pthread_mutex_lock(&priv->lock);
+    while (priv->flushed < head)
+    {
+        pthread_cond_wait(&priv->done, &priv->lock);
+    }
+    pthread_mutex_unlock(&priv->lock);
+
+    return !atomic_load(&priv->failed);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t scallop_writer_dropped(scallop_writer_t * writer)
+{
+    OBJECT_PRIV(scallop_, writer);
+    return priv->dropped;
+}
+
+//------------------------------------------------------------------------|
+const scallop_writer_t scallop_writer_pub = {
+    &scallop_writer_create,
+    &scallop_writer_destroy,
+    &scallop_writer_push,
+    &scallop_writer_flush,
+    &scallop_writer_dropped,
+    NULL
+};
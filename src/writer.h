@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// What push() does when the queue is full
+typedef enum
+{
+    // Discard the record, counting it in dropped()
+    SCALLOP_WRITER_DROP = 0,
+
+    // Wait for the writer thread to make room
+    SCALLOP_WRITER_WAIT
+}
+scallop_writer_policy_t;
+
+// Write one record to the file, from the writer thread
+typedef void (*scallop_writer_format_f)(FILE * file, const void * record);
+
+//------------------------------------------------------------------------|
+// A background writer takes file output off the calling thread.  Records
+// of a fixed size are copied into a bounded queue, which a thread of its
+// own drains, formats and writes.  There must be only one thread pushing
+// records, and it never takes a lock or makes a system call to do so,
+// unless the writer thread is idle and needs waking.
+typedef struct scallop_writer_t
+{
+    // Writer factory function.  Opens the file, to append to or replace,
+    // allocates room for capacity records of record_size bytes each, and
+    // starts the thread.  Returns NULL if any of that fails.
+    struct scallop_writer_t * (*create)(const char * path,
+                                        bool append,
+                                        size_t record_size,
+                                        size_t capacity,
+                                        scallop_writer_format_f format,
+                                        scallop_writer_policy_t policy);
+
+    // Writer destructor function.  Writes out everything queued first.
+    void (*destroy)(void * writer);
+
+    // Queue a copy of a record to be written.  Returns false if it was
+    // dropped because the queue is full.
+    bool (*push)(struct scallop_writer_t * writer, const void * record);
+
+    // Wait until everything queued so far is written and flushed to the
+    // file.  Returns false if there has been an error writing.
+    bool (*flush)(struct scallop_writer_t * writer);
+
+    // Get the number of records dropped so far
+    size_t (*dropped)(struct scallop_writer_t * writer);
+
+    // Private data
+    void * priv;
+}
+scallop_writer_t;
+
+//------------------------------------------------------------------------|
+extern const scallop_writer_t scallop_writer_pub;
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "bench.h"
+#include "allocs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+size_t bench_allocs()
+{
+    return allocs_count();
+}
+
+//------------------------------------------------------------------------|
+static inline long long bench_now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+//------------------------------------------------------------------------|
+void bench_header()
+{
+    printf("# %-38s %10s %12s %10s\n", "name", "iterations", "ns/op", "allocs/op");
+}
+
+//------------------------------------------------------------------------|
+void bench_run(const char * name,
+               size_t iterations,
+               bench_f func,
+               void * context)
+{
+    long long start = 0;
+    long long elapsed = 0;
+    size_t allocs = 0;
+    size_t index = 0;
+
+    // One untimed pass to warm caches and grow any lazily sized buffers
+    func(context);
+
+    allocs = allocs_count();
+    start = bench_now_ns();
+    for (index = 0; index < iterations; index++)
+    {
+        func(context);
+    }
+
+    elapsed = bench_now_ns() - start;
+    allocs = allocs_count() - allocs;
+
+    printf("%-40s %10zu %12.1f %10.2f\n",
+           name,
+           iterations,
+           (double) elapsed / (double) iterations,
+           (double) allocs / (double) iterations);
+    fflush(stdout);
+}
@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Minimal microbenchmark harness.  Each benchmark is a function run some
+// number of iterations, timed against a monotonic clock.  Results go to
+// stdout one per line as whitespace separated columns:
+//
+//     <name> <iterations> <ns/op> <allocs/op>
+//
+// so that runs from two builds can be compared with diff or awk.  Lines
+// starting with '#' are comments.  Allocations are only counted when
+// linked with -Wl,--wrap for malloc, calloc, realloc and free, as
+// 'make bench' does; otherwise allocs/op reads zero.
+typedef void (*bench_f)(void * context);
+
+//------------------------------------------------------------------------|
+// Print the column header
+void bench_header();
+
+// Time func over the given number of iterations and report it
+void bench_run(const char * name,
+               size_t iterations,
+               bench_f func,
+               void * context);
+
+// Number of allocations (malloc, calloc, realloc) made so far
+size_t bench_allocs();
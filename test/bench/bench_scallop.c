@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "utils.h"
+#include "console.h"
+#include "bytes.h"
+#include "chain.h"
+#include "scallop.h"
+#include "command.h"
+#include "builtin.h"
+#include "parser.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Scale of the registries being searched
+#define BENCH_COMMANDS          1000
+#define BENCH_VARIABLES         1000
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    scallop_t * scallop;
+    scallop_cmd_t * commands;
+    bytes_t * line;
+    const char * text;
+}
+bench_context_t;
+
+//------------------------------------------------------------------------|
+static int bench_handler_nop(void * scmd,
+                             void * context,
+                             int argc,
+                             char ** args)
+{
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static void bench_sparser_evaluate(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    console_t * console = bench->scallop->console(bench->scallop);
+    sparser_evaluate(console->error, console, bench->text);
+}
+
+//------------------------------------------------------------------------|
+static void bench_find_by_keyword(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    bench->commands->find_by_keyword(bench->commands, bench->text);
+}
+
+//------------------------------------------------------------------------|
+// What tab completion does for each keypress
+static void bench_partial_matches(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    size_t longest = 0;
+    chain_t * matches = bench->commands->partial_matches(bench->commands,
+                                                         bench->text,
+                                                         &longest);
+    if (matches)
+    {
+        matches->destroy(matches);
+    }
+}
+
+//------------------------------------------------------------------------|
+static void bench_substitute(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    bench->line->assign(bench->line, bench->text, strlen(bench->text));
+    bench->scallop->substitute(bench->scallop, bench->line);
+}
+
+//------------------------------------------------------------------------|
+static void bench_dispatch(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    bench->scallop->dispatch(bench->scallop, bench->text);
+}
+
+//------------------------------------------------------------------------|
+// Dispatch each line of a script, as 'source' would
+static void bench_dispatch_lines(scallop_t * scallop, const char ** lines)
+{
+    while (*lines)
+    {
+        scallop->dispatch(scallop, *lines++);
+    }
+}
+
+//------------------------------------------------------------------------|
+// Loop-heavy script bodies in the spirit of test/func
+static const char * bench_fib_decl[] = {
+    "routine fibonacci",
+    "  assign i 0",
+    "  assign j 1",
+    "  assign k 1",
+    "  while ({k} < {%1})",
+    "    assign k ({i} + {j})",
+    "    assign i {j}",
+    "    assign j {k}",
+    "  end",
+    "end",
+    NULL
+};
+
+static const char * bench_while_script[] = {
+    "assign w 0",
+    "while ({w} < 100)",
+    "  assign w ({w} + 1)",
+    "end",
+    NULL
+};
+
+static const char * bench_for_script[] = {
+    "assign total 0",
+    "for f 0 100",
+    "  assign total ({total} + {f})",
+    "end",
+    NULL
+};
+
+//------------------------------------------------------------------------|
+static void bench_while_loop(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    bench_dispatch_lines(bench->scallop, bench_while_script);
+}
+
+//------------------------------------------------------------------------|
+static void bench_for_loop(void * context)
+{
+    bench_context_t * bench = (bench_context_t * ) context;
+    bench_dispatch_lines(bench->scallop, bench_for_script);
+}
+
+//------------------------------------------------------------------------|
+int main(int argc, char * argv[])
+{
+    bench_context_t bench;
+    char name[64];
+    size_t index = 0;
+
+    BLAMMO_LEVEL(ERROR);
+    BLAMMO_STDOUT(false);
+
+    // Scripts print, and that is not what is being measured
+    FILE * devnull = fopen("/dev/null", "w");
+    console_t * console = console_pub.create(stdin,
+                                             devnull ? devnull : stdout,
+                                             "bench-history.txt");
+    memzero(&bench, sizeof(bench));
+    bench.scallop = scallop_pub.create(console,
+                                       register_builtin_commands,
+                                       "BENCH");
+    bench.line = bytes_pub.create(NULL, 0);
+    if (!console || !bench.scallop || !bench.line)
+    {
+        fprintf(stderr, "failed to create scallop\n");
+        return 1;
+    }
+
+    // A large flat command registry, apart from scallop's own
+    bench.commands = scallop_cmd_pub.create(NULL, NULL, NULL, NULL, NULL);
+    for (index = 0; index < BENCH_COMMANDS; index++)
+    {
+        snprintf(name, sizeof(name), "command%04zu", index);
+        bench.commands->register_cmd(bench.commands,
+                bench.commands->create(bench_handler_nop,
+                                       &bench,
+                                       name,
+                                       NULL,
+                                       "benchmark command"));
+    }
+
+    // Many variables in the environment
+    for (index = 0; index < BENCH_VARIABLES; index++)
+    {
+        snprintf(name, sizeof(name), "var%04zu", index);
+        bench.scallop->assign_variable(bench.scallop, name, name);
+    }
+
+    bench_header();
+    printf("# commands %d variables %d\n", BENCH_COMMANDS, BENCH_VARIABLES);
+
+    bench.text = "((1 + 2) * (30 - 4) / 2 + 7)";
+    bench_run("sparser_evaluate", 200000, bench_sparser_evaluate, &bench);
+
+    bench.text = "command0999";
+    bench_run("find_by_keyword/last", 20000, bench_find_by_keyword, &bench);
+
+    bench.text = "command0500";
+    bench_run("find_by_keyword/middle", 20000, bench_find_by_keyword, &bench);
+
+    bench.text = "command09";
+    bench_run("partial_matches/100", 2000, bench_partial_matches, &bench);
+
+    bench.text = "print {var0000} and {var0999} then {var0500}";
+    bench_run("substitute/3-refs", 20000, bench_substitute, &bench);
+
+    bench.text = "assign x 42";
+    bench_run("dispatch/assign", 20000, bench_dispatch, &bench);
+
+    bench.text = "assign x ({var0001} == {var0001})";
+    bench_run("dispatch/assign-expr", 20000, bench_dispatch, &bench);
+
+    bench_dispatch_lines(bench.scallop, bench_fib_decl);
+    bench.text = "fibonacci 1000";
+    bench_run("script/fibonacci-1000", 2000, bench_dispatch, &bench);
+
+    bench_run("script/while-100", 200, bench_while_loop, &bench);
+    bench_run("script/for-100", 200, bench_for_loop, &bench);
+
+    bench.commands->destroy(bench.commands);
+    bench.line->destroy(bench.line);
+    bench.scallop->destroy(bench.scallop);
+    console->destroy(console);
+    if (devnull)
+    {
+        fclose(devnull);
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+# Counting loops over a numeric range
+
+for i 0 3
+  print "up {i}"
+end
+print "after counting up, i is {i}"
+
+for i 10 0 -3
+  print "down {i}"
+end
+
+assign n 4
+for i 0 ({n} * 2) 2
+  if ({i} == 2)
+    continue
+  end
+  if ({i} == 6)
+    break
+  end
+  print "even {i}"
+end
+print "stopped at {i}"
+
+for row 1 3
+  for col 1 3
+    print "{row},{col}"
+  end
+end
+
+routine sum_to
+  assign total 0
+  for k 1 ({%1} + 1)
+    assign total ({total} + {k})
+  end
+  return {total}
+end
+
+sum_to 10
+print "sum to 10 is {%?}"
+
+for i 0 5 0
+end
+
+# Assigning the loop variable moves the counter itself
+for i 0 10
+  print "skip {i}"
+  assign i ({i} + 3)
+end
+print "after skipping, i is {i}"
+
+routine peek
+  print "peek sees {i}"
+end
+
+for i 0 2
+  peek
+end
+
+for i 0 3
+  assign i "three"
+  print "still {i}"
+  break
+end
+
+# Stepping stops at the end rather than overflowing
+for i 9223372036854775805 9223372036854775807 2
+  print "near the top {i}"
+end
+print "after the top, i is {i}"
@@ -15,3 +15,8 @@ if ({x} == 7)
 else
   print "x is not equal to 7"
 end
+
+# else only modifies an if-else or a switch
+while (0)
+else
+end
@@ -0,0 +1,59 @@
+# List variables, indexing and iteration
+
+list create fruit apple banana cherry
+print "first {fruit[0]}, last {fruit[-1]}"
+
+list push fruit date (2 * 21)
+list length fruit
+print "fruit has {%?} items"
+
+for i 0 3
+  print "fruit {i} is {fruit[i]}"
+end
+
+list set fruit 1 blueberry
+list pop fruit popped
+print "popped {popped}, second is now {fruit[1]}"
+
+assign seen 0
+foreach f fruit
+  assign seen ({seen} + 1)
+  if ({seen} == 1)
+    continue
+  end
+  print "each {f}"
+end
+print "after foreach, f is {f}"
+
+list create squares
+for n 1 5
+  list push squares ({n} * {n})
+end
+
+routine total
+  assign sum 0
+  foreach x {%1}
+    assign sum ({sum} + {x})
+  end
+  return {sum}
+end
+
+total squares
+print "sum of squares is {%?}"
+
+list create empty
+foreach e empty
+  print "never printed"
+end
+
+list delete empty
+print {empty[0]}
+print {fruit[9]}
+
+# Assigning the loop variable replaces the item in the list
+list create shout a b c
+foreach s shout
+  assign s "{s}!"
+end
+print "{shout[0]} {shout[1]} {shout[2]}"
+list delete shout
@@ -0,0 +1,40 @@
+# Map variables and key references
+
+map set port http 80
+map set port https 443
+map set port ssh 22
+print "https is on {port.https}"
+
+map get port ssh sshport
+print "ssh is on {sshport}"
+
+map set port http 8080
+map del port ssh
+map size port
+print "port has {%?} keys"
+
+map keys port names
+foreach name names
+  map get port {name} number
+  print "{name} -> {number}"
+end
+
+for i 0 100
+  assign id ({i} / 15)
+  map set counts {id} ({i} * 2)
+end
+map size counts
+print "counts has {%?} keys, 3 maps to {counts.3}"
+
+for i 0 1000
+  map set big k{i} {i}
+end
+for i 0 1000 2
+  map del big k{i}
+end
+map size big
+print "big has {%?} keys, k999 is {big.k999}"
+
+map del big
+print {big.k1}
+print {port.ftp}
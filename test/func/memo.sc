@@ -0,0 +1,17 @@
+# Pure routine memoization: the body should only run once per
+# distinct argument vector.  The result is the last line's result.
+routine pure square
+  print "computing square of {%1}"
+  assign sq ({%1} * {%1})
+end
+
+square 7
+print "square 7 is {%?}"
+square 7
+print "square 7 is {%?}"
+square 8
+print "square 8 is {%?}"
+
+memo stats
+memo clear square
+memo stats square
@@ -0,0 +1,42 @@
+# Pipelines: each command's output is the next command's input
+
+print one two three | print
+
+# Collect output into a list without an intermediate variable
+print apple banana cherry | list create fruit
+list length fruit
+print "fruit has {%?} items"
+foreach f fruit
+  print "fruit: {f}"
+end
+print "date" (2 * 21) | list push fruit
+print "now last is {fruit[-1]}"
+
+# Or all of it into one variable
+print "a b" c | assign text
+print "text is {text}"
+
+# Pipes inside quotes, expressions and 'or' are left alone
+print "x | y" (0 || 1)
+
+# Routines pass their input on to the lines they run
+routine shout
+  print "shouting:"
+  print
+end
+print hey there | shout
+print several stages | print | print
+
+# Pipelines stored in routines are run with them
+routine count
+  help | list create helplines
+  list length helplines
+  return ({%?} > 10)
+end
+count
+print "help has more than ten lines: {%?}"
+
+# Errors
+print nothing | | print
+print nothing | while (1)
+print
@@ -0,0 +1,40 @@
+# Per-command profiling.  Times vary, so only the counts are checked.
+
+profile reset
+profile on
+
+routine square
+  return ({%1} * {%1})
+end
+
+for i 0 10
+  square {i}
+end
+print {nonexistent}
+unknowncommand
+assign x (1 +)
+
+profile off
+profile show
+
+# Line-level listing of routine bodies
+profile reset
+profile on
+routine collatz
+  assign n {%1}
+  assign steps 0
+  while ({n} != 1)
+    if ({n} - {n} / 2 * 2)
+      assign n (3 * {n} + 1)
+    else
+      assign n ({n} / 2)
+    end
+    assign steps ({steps} + 1)
+  end
+  return {steps}
+end
+collatz 27
+print "collatz 27 takes {%?} steps"
+profile off
+profile listing collatz
+profile listing
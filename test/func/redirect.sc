@@ -0,0 +1,21 @@
+# Redirecting command output to files
+
+# Write a script, then run it
+print "print first" > redirect.tmp
+print "print second" "print third" >> redirect.tmp
+source redirect.tmp
+
+# Replacing, with the file named by a variable and a pipeline before it
+assign out redirect.tmp
+print "print replaced" | print > {out}
+source {out}
+
+# Comparisons inside expressions and quotes are left alone
+assign n (2 > 1)
+print "n > 0" {n}
+
+# Errors
+> {out}
+print nothing > a b
+print nothing > /no/such/dir/file
+print done
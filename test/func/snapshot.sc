@@ -0,0 +1,32 @@
+# Snapshot save and restore of variables, routines and aliases
+
+assign greeting "hello there"
+assign count 3
+routine twice
+  return ({%1} * 2)
+end
+routine pure square
+  return ({%1} * {%1})
+end
+alias say print
+alias shout say
+snapshot save snapshot.tmp
+
+# Forget all of it, then bring it back
+unreg shout
+unreg say
+unreg twice
+unreg square
+assign greeting "changed"
+snapshot load snapshot.tmp
+print "{%?}"
+shout "{greeting} {count}"
+twice 21
+say "twice 21 is {%?}"
+square 12
+say "square 12 is {%?}"
+
+# Existing commands are not replaced
+snapshot load snapshot.tmp
+snapshot load /nonexistent/snapshot.bin
+snapshot save /nonexistent/dir/snapshot.bin
@@ -0,0 +1,4 @@
+# Sourcing what opens but cannot be read reports only why reading
+# failed, not that the file could not be opened
+
+source .
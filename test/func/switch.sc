@@ -0,0 +1,36 @@
+# Selecting among arms of a switch by value
+
+routine describe
+  switch {%1}
+  case 0
+    print "{%1} is zero"
+  case 1 3 5 7 9
+    print "{%1} is a small odd number"
+  case 2 4 6 8
+    print "{%1} is a small even number"
+  else
+    print "{%1} is something else"
+  end
+end
+
+for n 0 13 3
+  describe {n}
+end
+
+assign x 4
+switch ({x} * 2)
+case 0x8
+  print "hex labels work too"
+end
+
+switch 42
+case 1
+  print "no match and no else prints nothing"
+end
+
+switch 1
+case 1
+  print "a rejected case adds nothing to the arm before"
+case 2 3 2
+  print "so this never runs"
+end
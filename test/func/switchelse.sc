@@ -0,0 +1,10 @@
+# The else arm of a switch must come last
+
+switch 3
+case 1 2
+  print "one or two"
+else
+  print "neither"
+case 3
+  print "unreachable"
+end
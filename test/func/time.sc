@@ -0,0 +1,28 @@
+# Timing commands from inside the shell.  Costs vary, so only check
+# what doesn't: results pass through and the elapsed time is stored.
+
+routine sum
+  assign total 0
+  for i 1 {%1}
+    assign total ({total} + {i})
+  end
+  return {total}
+end
+
+time sum 100
+print "sum is {%?}"
+
+if ({time_ns} > 0)
+  print "elapsed time was stored"
+end
+
+if ({time_ns} < 10000000000)
+  print "and is within budget"
+end
+
+time assign x 5
+print "x is {x}"
+
+time
+time nonexistent
+time while (1)
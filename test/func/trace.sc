@@ -0,0 +1,24 @@
+# Trace-event recording.  The timeline itself varies, so only check
+# that recording and dumping work.
+
+trace start 1000
+routine count
+  assign i 0
+  while ({i} < {%1})
+    assign i ({i} + 1)
+  end
+  return {i}
+end
+count 5
+print "counted to {%?}"
+trace stop
+trace dump trace.tmp
+
+# Too small a buffer keeps only the newest events
+trace start 8
+count 5
+trace stop
+trace dump trace_small.tmp
+
+trace dump /nonexistent/dir/trace.json
+trace start 0
@@ -0,0 +1,40 @@
+# Early exit from loops and routines with break, continue and return
+
+assign i 0
+while ({i} < 10)
+  assign i ({i} + 1)
+  if ({i} == 2)
+    continue
+  end
+  if ({i} > 4)
+    break
+  end
+  print "i is {i}"
+end
+print "loop ended with i at {i}"
+
+routine double
+  if ({%1} < 0)
+    return -1
+  end
+  return ({%1} * 2)
+  print "you should not see this"
+end
+
+double 21
+print "double 21 is {%?}"
+double -5
+print "double -5 is {%?}"
+
+routine first_over
+  assign n 0
+  while (1)
+    assign n ({n} + 1)
+    if ({n} > {%1})
+      return {n}
+    end
+  end
+end
+
+first_over 6
+print "first over 6 is {%?}"
@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "allocs.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+// Running count bumped by the allocator wrappers below, from any thread
+static atomic_size_t allocs_allocations = 0;
+
+// The real allocator, reached through the linker's --wrap option
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * ptr, size_t size);
+void __real_free(void * ptr);
+
+//------------------------------------------------------------------------|
+void * __wrap_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs_allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void * __wrap_calloc(size_t count, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs_allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void * __wrap_realloc(void * ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs_allocations, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void * ptr)
+{
+    __real_free(ptr);
+}
+
+//------------------------------------------------------------------------|
+size_t allocs_count()
+{
+    return atomic_load_explicit(&allocs_allocations, memory_order_relaxed);
+}
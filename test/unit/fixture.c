@@ -22,6 +22,7 @@
 //------------------------------------------------------------------------|
 
 #include "fixture.h"
+#include "allocs.h"
 #include "utils.h"
 #include "blammo.h"
 
@@ -33,6 +34,11 @@
 // The test fixture
 static fixture_t fixture;
 
+size_t fixture_allocs()
+{
+    return allocs_count();
+}
+
 //------------------------------------------------------------------------|
 void fixture_reset()
 {
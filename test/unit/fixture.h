@@ -38,3 +38,7 @@ fixture_t;
 //------------------------------------------------------------------------|
 void fixture_reset();
 void fixture_report();
+
+// Heap allocations (malloc, calloc and realloc calls) made so far, as
+// counted by the allocator wrappers in allocs.c
+size_t fixture_allocs();
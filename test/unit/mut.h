@@ -136,4 +136,24 @@
 
 
 
+// Heap allocation count, from fixture_allocs()
+#include "fixture.h"
+
+
+
+#define CHECK_ALLOCS(__expression__, __max__)                                  \
+    {                                                                          \
+        size_t __allocs__ = fixture_allocs();                                  \
+        (void) (__expression__);                                               \
+        __allocs__ = fixture_allocs() - __allocs__;                            \
+        if (__allocs__ > (size_t) (__max__))                                   \
+        {                                                                      \
+            BLAMMO(ERROR, "%zu allocations, expected at most %zu",             \
+                __allocs__, (size_t) (__max__));                               \
+            __ASSERTION_FAILED__                                               \
+        }                                                                      \
+    }
+
+
+
 #endif
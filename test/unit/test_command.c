@@ -59,6 +59,34 @@ TEST_BEGIN("test create/destroy")
 
 TEST_END
 
+TEST_BEGIN("test profiling stats")
+    scallop_cmd_t * scallcmd = scallop_cmd_pub.create(bogus_scallcmd_handler,
+                                                      NULL,
+                                                      "test",
+                                                      " <hint>",
+                                                      "a bogus test command");
+    CHECK(scallcmd != NULL);
+
+    // Nothing is counted while profiling is off
+    scallcmd->exec(scallcmd, 0, NULL);
+    CHECK(scallcmd->stats(scallcmd)->calls == 0);
+
+    scallop_cmd_pub.set_profiling(true);
+    CHECK(scallop_cmd_pub.is_profiling());
+    scallcmd->exec(scallcmd, 0, NULL);
+    scallcmd->exec(scallcmd, 0, NULL);
+    scallop_cmd_pub.set_profiling(false);
+    CHECK(scallcmd->stats(scallcmd)->calls == 2);
+    CHECK(scallcmd->stats(scallcmd)->errors == 0);
+    CHECK(scallcmd->stats(scallcmd)->max_ns <=
+          scallcmd->stats(scallcmd)->total_ns);
+
+    scallcmd->reset_stats(scallcmd);
+    CHECK(scallcmd->stats(scallcmd)->calls == 0);
+
+    scallcmd->destroy(scallcmd);
+TEST_END
+
 TEST_BEGIN("test register/unregister")
     CHECK(true);
 TEST_END
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <string.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include "blammo.h"
+#include "utils.h"
+#include "mut.h"
+
+#include "lines.h"
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_lines.log");
+    BLAMMO(INFO, "lines tests...");
+
+TEST_BEGIN("test create/destroy")
+    scallop_lines_t * lines = scallop_lines_pub.create();
+    CHECK(lines != NULL);
+    CHECK(lines->count(lines) == 0);
+    CHECK(lines->line(lines, 0) == NULL);
+    lines->destroy(lines);
+TEST_END
+
+TEST_BEGIN("test append/index")
+    scallop_lines_t * lines = scallop_lines_pub.create();
+    lines->append(lines, "print hello");
+    lines->append(lines, "");
+    lines->append(lines, "assign i ({i} + 1)");
+
+    CHECK(lines->count(lines) == 3);
+    CHECK(!strcmp(lines->line(lines, 0), "print hello"));
+    CHECK(!strcmp(lines->line(lines, 1), ""));
+    CHECK(!strcmp(lines->line(lines, 2), "assign i ({i} + 1)"));
+    CHECK(lines->length(lines, 0) == 11);
+    CHECK(lines->length(lines, 1) == 0);
+    CHECK(lines->length(lines, 2) == 18);
+    CHECK(lines->line(lines, 3) == NULL);
+    lines->destroy(lines);
+TEST_END
+
+TEST_BEGIN("test growth")
+    scallop_lines_t * lines = scallop_lines_pub.create();
+    char buffer[32];
+    size_t index = 0;
+
+    // Enough lines to force several reallocations of both arrays
+    for (index = 0; index < 10000; index++)
+    {
+        snprintf(buffer, sizeof(buffer), "print %zu", index);
+        lines->append(lines, buffer);
+    }
+
+    CHECK(lines->count(lines) == 10000);
+    CHECK(!strcmp(lines->line(lines, 0), "print 0"));
+    CHECK(!strcmp(lines->line(lines, 4321), "print 4321"));
+    CHECK(!strcmp(lines->line(lines, 9999), "print 9999"));
+    lines->destroy(lines);
+TEST_END
+
+TEST_BEGIN("test stats/origin")
+    scallop_lines_t * body = scallop_lines_pub.create();
+    scallop_lines_t * loop = scallop_lines_pub.create();
+    scallop_lines_stats_t * stats = NULL;
+    scallop_lines_stats_t * previous = NULL;
+
+    body->append(body, "while ({i} < 3)");
+    body->append(body, "end");
+    CHECK(body->stats(body, 2) == NULL);
+
+    // Statistics start out cleared, and cover lines appended later
+    stats = body->stats(body, 0);
+    CHECK(stats != NULL);
+    CHECK(stats->hits == 0 && stats->total_ns == 0);
+    body->append(body, "print done");
+    CHECK(body->stats(body, 2) != NULL);
+    CHECK(body->stats(body, 2)->hits == 0);
+
+    // Lines stored while an origin is set refer back to it
+    stats = body->stats(body, 0);
+    previous = scallop_lines_pub.set_origin(stats);
+    CHECK(previous == NULL);
+    loop->append(loop, "assign i ({i} + 1)");
+    CHECK(scallop_lines_pub.set_origin(previous) == stats);
+    loop->append(loop, "print {i}");
+    CHECK(loop->origin(loop, 0) == stats);
+    CHECK(loop->origin(loop, 1) == NULL);
+    CHECK(body->origin(body, 0) == NULL);
+
+    stats->hits = 5;
+    body->reset_stats(body);
+    CHECK(body->stats(body, 0)->hits == 0);
+
+    loop->destroy(loop);
+    body->destroy(body);
+TEST_END
+
+TESTSUITE_END
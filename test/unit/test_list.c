@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <string.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include "blammo.h"
+#include "utils.h"
+#include "mut.h"
+
+#include "list.h"
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_list.log");
+    BLAMMO(INFO, "list tests...");
+
+TEST_BEGIN("test create/destroy")
+    scallop_list_t * list = scallop_list_pub.create();
+    CHECK(list != NULL);
+    CHECK(list->length(list) == 0);
+    CHECK(list->get(list, 0) == NULL);
+    CHECK(list->get(list, -1) == NULL);
+    CHECK(!list->pop(list));
+    list->destroy(list);
+TEST_END
+
+TEST_BEGIN("test push/get/set/pop")
+    scallop_list_t * list = scallop_list_pub.create();
+    CHECK(list->push(list, "one"));
+    CHECK(list->push(list, ""));
+    CHECK(list->push(list, "three"));
+
+    CHECK(list->length(list) == 3);
+    CHECK(!strcmp(list->get(list, 0), "one"));
+    CHECK(!strcmp(list->get(list, 1), ""));
+    CHECK(!strcmp(list->get(list, 2), "three"));
+    CHECK(!strcmp(list->get(list, -1), "three"));
+    CHECK(!strcmp(list->get(list, -3), "one"));
+    CHECK(list->get(list, 3) == NULL);
+    CHECK(list->get(list, -4) == NULL);
+
+    CHECK(list->set(list, -2, "two"));
+    CHECK(!strcmp(list->get(list, 1), "two"));
+    CHECK(!list->set(list, 3, "four"));
+
+    CHECK(list->pop(list));
+    CHECK(list->length(list) == 2);
+    CHECK(list->get(list, 2) == NULL);
+
+    list->clear(list);
+    CHECK(list->length(list) == 0);
+    list->destroy(list);
+TEST_END
+
+TEST_BEGIN("test growth")
+    scallop_list_t * list = scallop_list_pub.create();
+    char buffer[32];
+    long index = 0;
+
+    for (index = 0; index < 10000; index++)
+    {
+        snprintf(buffer, sizeof(buffer), "%ld", index);
+        CHECK(list->push(list, buffer));
+    }
+
+    CHECK(list->length(list) == 10000);
+    CHECK(!strcmp(list->get(list, 0), "0"));
+    CHECK(!strcmp(list->get(list, 4321), "4321"));
+    CHECK(!strcmp(list->get(list, -1), "9999"));
+    list->destroy(list);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include "blammo.h"
+#include "utils.h"
+#include "mut.h"
+
+#include "map.h"
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_map.log");
+    BLAMMO(INFO, "map tests...");
+
+TEST_BEGIN("test create/destroy")
+    scallop_map_t * map = scallop_map_pub.create();
+    size_t cursor = 0;
+    const char * key = NULL;
+    const char * value = NULL;
+
+    CHECK(map != NULL);
+    CHECK(map->size(map) == 0);
+    CHECK(map->get(map, "missing") == NULL);
+    CHECK(!map->remove(map, "missing"));
+    CHECK(!map->next(map, &cursor, &key, &value));
+    map->destroy(map);
+TEST_END
+
+TEST_BEGIN("test set/get/remove")
+    scallop_map_t * map = scallop_map_pub.create();
+    CHECK(map->set(map, "http", "80"));
+    CHECK(map->set(map, "ssh", "22"));
+    CHECK(map->set(map, "", "empty key"));
+
+    CHECK(map->size(map) == 3);
+    CHECK(!strcmp(map->get(map, "http"), "80"));
+    CHECK(!strcmp(map->get(map, "ssh"), "22"));
+    CHECK(!strcmp(map->get(map, ""), "empty key"));
+
+    CHECK(map->set(map, "http", "8080"));
+    CHECK(map->size(map) == 3);
+    CHECK(!strcmp(map->get(map, "http"), "8080"));
+
+    CHECK(map->remove(map, "ssh"));
+    CHECK(!map->remove(map, "ssh"));
+    CHECK(map->get(map, "ssh") == NULL);
+    CHECK(map->size(map) == 2);
+    map->destroy(map);
+TEST_END
+
+TEST_BEGIN("test incremental resize")
+    scallop_map_t * map = scallop_map_pub.create();
+    char key[32];
+    char value[32];
+    const char * found = NULL;
+    const char * nextkey = NULL;
+    size_t cursor = 0;
+    size_t count = 0;
+    long index = 0;
+    bool matched = true;
+
+    // Enough keys to go through several resizes, checking everything
+    // inserted so far remains reachable part way through each one
+    for (index = 0; index < 5000; index++)
+    {
+        snprintf(key, sizeof(key), "key%ld", index);
+        snprintf(value, sizeof(value), "%ld", index * 3);
+        CHECK(map->set(map, key, value));
+
+        snprintf(key, sizeof(key), "key%ld", index / 2);
+        snprintf(value, sizeof(value), "%ld", (index / 2) * 3);
+        found = map->get(map, key);
+        matched &= (found && !strcmp(found, value));
+    }
+
+    CHECK(matched);
+    CHECK(map->size(map) == 5000);
+
+    // Remove every other key, leaving tombstones behind
+    for (index = 0; index < 5000; index += 2)
+    {
+        snprintf(key, sizeof(key), "key%ld", index);
+        CHECK(map->remove(map, key));
+    }
+
+    CHECK(map->size(map) == 2500);
+    CHECK(map->get(map, "key0") == NULL);
+    CHECK(!strcmp(map->get(map, "key4999"), "14997"));
+
+    // Iteration visits each remaining key exactly once
+    while (map->next(map, &cursor, &nextkey, &found))
+    {
+        count++;
+    }
+
+    CHECK(count == 2500);
+    map->destroy(map);
+TEST_END
+
+TESTSUITE_END
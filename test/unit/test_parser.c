@@ -46,6 +46,15 @@ TESTSUITE_BEGIN
     BLAMMO_FILE("test_sparser.log");
     BLAMMO(INFO, "sparser tests...");
 
+TEST_BEGIN("allocations")
+    // Parsing and evaluation work in place, without the heap
+    CHECK_ALLOCS(evalexpr("2 + 3"), 0);
+    CHECK_ALLOCS(evalexpr("((1 + 2) * 3) - 4 / 2"), 0);
+    CHECK_ALLOCS(evalexpr("(5 > 3) && !(2 == 7)"), 0);
+    CHECK_ALLOCS(sparser_is_expr("(1 + 2)"), 0);
+    CHECK_ALLOCS(sparser_is_expr("not an expression"), 0);
+TEST_END
+
 TEST_BEGIN("addition")
     CHECK(evalexpr("2 + 3") == 5);
     CHECK(evalexpr("5678 + 998877") == 1004555);
@@ -24,12 +24,19 @@
 #include "blammo.h"
 #include "utils.h"
 #include "console.h"
+#include "bytes.h"
 #include "scallop.h"
+#include "builtin.h"
+#include "script.h"
+#include "fixture.h"
 #include "mut.h"
 
 #include <string.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
 
 static bool dummy_registration_func(void * scallop)
 {
@@ -37,6 +44,54 @@ static bool dummy_registration_func(void * scallop)
     return true;
 }
 
+// Counts calls in the size_t it's given, and provides the count
+static bool counting_provider(void * object, const char * name, void * value)
+{
+    size_t * calls = (size_t *) object;
+    bytes_t * text = (bytes_t *) value;
+
+    (*calls)++;
+    text->print(text, "%zu", *calls);
+    return strcmp(name, "missing") != 0;
+}
+
+// Feeds a pipe in two writes, splitting a line between them, and holds
+// the second until the reader has drained the first.  The last line has
+// no newline.
+static void * split_writer(void * fd_ptr)
+{
+    int fd = *(int *) fd_ptr;
+    const char * first = "assign a 1\r\nassign b 2";
+    const char * second = "2\nassign c 3";
+    int pending = 0;
+
+    (void) !write(fd, first, strlen(first));
+    while (ioctl(fd, FIONREAD, &pending) == 0 && pending > 0)
+    {
+        usleep(1000);
+    }
+
+    usleep(10000);
+    (void) !write(fd, second, strlen(second));
+    close(fd);
+    return NULL;
+}
+
+// Reads a whole (small) file into text as a string, empty if it can't
+static char * read_text(const char * path, char * text, size_t size)
+{
+    FILE * file = fopen(path, "r");
+
+    text[0] = '\0';
+    if (file)
+    {
+        text[fread(text, 1, size - 1, file)] = '\0';
+        fclose(file);
+    }
+
+    return text;
+}
+
 TESTSUITE_BEGIN
 
     // Simple test of the blammo logger
@@ -57,6 +112,521 @@ TEST_BEGIN("test create/destroy")
 
 TEST_END
 
+TEST_BEGIN("test allocations")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    scallop_cmd_t * cmds = scallop->commands(scallop);
+    bytes_t * text = NULL;
+    size_t bytes_cost = fixture_allocs();
+    size_t first = 0;
+    long value = 0;
+
+    // What one short temporary bytes_t costs is up to RayCO, so the
+    // counts below are in terms of it.
+    text = bytes_pub.create("assign", 6);
+    bytes_cost = fixture_allocs() - bytes_cost;
+    text->destroy(text);
+
+    scallop->dispatch(scallop, "assign x 5");
+    scallop->dispatch(scallop, "list create fruit apple pear");
+
+    // Lookups copy the key at most
+    CHECK_ALLOCS(cmds->find_by_keyword(cmds, "assign"), bytes_cost);
+    CHECK_ALLOCS(scallop->list_by_name(scallop, "fruit"), 0);
+    CHECK_ALLOCS(scallop->map_by_name(scallop, "fruit"), 0);
+
+    // Substitution takes two scratch buffers, even with nothing to do
+    text = bytes_pub.create("no references here", 18);
+    CHECK_ALLOCS(scallop->substitute(scallop, text), 2 * bytes_cost);
+    text->destroy(text);
+
+    // Evaluation copies the text, then substitutes
+    CHECK_ALLOCS(scallop->evaluate_value(scallop, "42", 2, &value),
+                 3 * bytes_cost);
+    CHECK(value == 42);
+
+    // Repeating the same dispatch costs no more than the first time,
+    // so nothing is growing from one line to the next.
+    first = fixture_allocs();
+    scallop->dispatch(scallop, "assign x 6");
+    first = fixture_allocs() - first;
+    CHECK_ALLOCS(scallop->dispatch(scallop, "assign x 7"), first);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test compiled scripts")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    scallop_script_t * script = NULL;
+    size_t dispatches = 0;
+    size_t plain = 0;
+    char saved[32];
+    char image[4096];
+    char * forged = NULL;
+    size_t size = 0;
+    int fds[2] = { -1, -1 };
+    long value = 0;
+    FILE * file = fopen("test_script.sc", "w");
+    CHECK(file != NULL);
+    fputs("# comment\r\n"
+          "routine twice\n"
+          "  assign t ({%1} * 2)\n"
+          "  while ({t} > 100)\n"
+          "    assign t ({t} - 100)\n"
+          "  end\n"
+          "end\n"
+          "\n"
+          "twice 21", file);
+    fclose(file);
+
+    // Nothing saved yet, so it compiles, and then loads what was saved
+    script = scallop_script_pub.create(scallop, "test_script.sc");
+    CHECK(script != NULL);
+    CHECK(!script->load(script, "."));
+    CHECK(script->compile(script));
+    CHECK(script->save(script, "."));
+    CHECK(script->load(script, "."));
+
+    // Lines stored without a lookup still count as dispatched, as they
+    // do run from the source, which also has a comment and a blank line
+    dispatches = scallop->dispatches(scallop);
+    CHECK(scallop->run_file(scallop, "test_script.sc") == 0);
+    plain = scallop->dispatches(scallop) - dispatches;
+    dispatches = scallop->dispatches(scallop);
+    CHECK(script->run(script) == 0);
+    CHECK(scallop->dispatches(scallop) - dispatches + 2 == plain);
+    snprintf(saved, sizeof(saved), "%016llx%s",
+             (unsigned long long) script->hash(script),
+             SCALLOP_SCRIPT_EXTENSION);
+    script->destroy(script);
+
+    CHECK(scallop->routine_by_name(scallop, "twice") != NULL);
+    CHECK(scallop->evaluate_value(scallop, "{t}", 3, &value));
+    CHECK(value == 42);
+
+    // The nested loop was stored whole, not run
+    scallop->dispatch(scallop, "twice 60");
+    CHECK(scallop->evaluate_value(scallop, "{t}", 3, &value));
+    CHECK(value == 20);
+
+    // A compiled form whose text doesn't match the source is not used,
+    // even with the same hash and size
+    file = fopen(saved, "r");
+    CHECK(file != NULL);
+    size = fread(image, 1, sizeof(image), file);
+    fclose(file);
+    // The last line's text comes last
+    forged = &image[size - 2];
+    CHECK(size > 2 && *forged == '1');
+    *forged = '2';
+    file = fopen(saved, "w");
+    fwrite(image, 1, size, file);
+    fclose(file);
+
+    script = scallop_script_pub.create(scallop, "test_script.sc");
+    CHECK(script != NULL);
+    CHECK(!script->load(script, "."));
+    script->destroy(script);
+
+    // A pipe can't be mapped, or read twice, so its source is kept
+    CHECK(pipe(fds) == 0);
+    CHECK(write(fds[1], "assign t 7\n", 11) == 11);
+    close(fds[1]);
+    snprintf(image, sizeof(image), "/dev/fd/%d", fds[0]);
+    script = scallop_script_pub.create(scallop, image);
+    close(fds[0]);
+    CHECK(script != NULL);
+    CHECK(script->run(script) == 0);
+    CHECK(scallop->evaluate_value(scallop, "{t}", 3, &value));
+    CHECK(value == 7);
+    script->destroy(script);
+
+    // Any edit makes a different compiled script
+    file = fopen("test_script.sc", "a");
+    fputs("\n", file);
+    fclose(file);
+
+    script = scallop_script_pub.create(scallop, "test_script.sc");
+    CHECK(script != NULL);
+    CHECK(!script->load(script, "."));
+    script->destroy(script);
+
+    CHECK(scallop_script_pub.create(scallop, "no-such-script.sc") == NULL);
+
+    CHECK(remove(saved) == 0);
+    CHECK(remove("test_script.sc") == 0);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test pipelines and redirection")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    scallop_stream_t * stream = scallop_stream_pub.create();
+    scallop_list_t * list = NULL;
+    FILE * file = NULL;
+    char text[32];
+    long value = 0;
+    CHECK(stream != NULL);
+
+    // Lines come back without their endings, the last one unterminated
+    fputs("one\r\ntwo\n\nthree", stream->writer(stream));
+    CHECK(stream->size(stream) == 15);
+    CHECK(strcmp(stream->read_line(stream), "one") == 0);
+    CHECK(stream->writer(stream) == NULL);
+    CHECK(strcmp(stream->read_line(stream), "two") == 0);
+    CHECK(strcmp(stream->read_line(stream), "") == 0);
+    CHECK(strcmp(stream->read_line(stream), "three") == 0);
+    CHECK(stream->read_line(stream) == NULL);
+    stream->destroy(stream);
+
+    // Output goes to the next command instead of the console
+    CHECK(scallop->input(scallop) == NULL);
+    scallop->dispatch(scallop, "print a (1 || 0) \"b | c\" | list create items");
+    CHECK(console->get_outputf(console) == stdout);
+    CHECK(scallop->input(scallop) == NULL);
+    list = scallop->list_by_name(scallop, "items");
+    CHECK(list != NULL);
+    CHECK(list->length(list) == 3);
+    CHECK(strcmp(list->get(list, 2), "b | c") == 0);
+
+    scallop->dispatch(scallop, "print 5 | print | assign n");
+    CHECK(scallop->evaluate_value(scallop, "{n}", 3, &value));
+    CHECK(value == 5);
+
+    scallop->dispatch(scallop, "print x | | print");
+    CHECK(scallop->evaluate_value(scallop, "{%?}", 4, &value));
+    CHECK(value == ERROR_MARKER_DEC);
+
+    // Redirected output goes to the file alone
+    scallop->dispatch(scallop, "print one > test_redirect.txt");
+    scallop->dispatch(scallop, "print two | print >> test_redirect.txt");
+    CHECK(console->get_outputf(console) == stdout);
+    file = fopen("test_redirect.txt", "r");
+    CHECK(file != NULL);
+    text[fread(text, 1, sizeof(text) - 1, file)] = '\0';
+    CHECK(strncmp(text, "one", 3) == 0);
+    CHECK(strstr(text, "two") != NULL);
+    fclose(file);
+    CHECK(remove("test_redirect.txt") == 0);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test invoke")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    char * assign[] = { "assign", "x", "(6 * 7)" };
+    char * create[] = { "create", "fruit", "apple" };
+    char * push[] = { "push", "fruit", "kiwi" };
+    char * length[] = { "length", "fruit" };
+    char * loop[] = { "while", "(0)" };
+    char * unknown[] = { "no-such-command" };
+    scallop_list_t * list = NULL;
+    size_t invoked = 0;
+    size_t dispatched = 0;
+    long value = 0;
+
+    CHECK(scallop->invoke(scallop, 3, assign) == 42);
+    CHECK(scallop->evaluate_value(scallop, "{x}", 3, &value));
+    CHECK(value == 42);
+    CHECK(scallop->evaluate_value(scallop, "{%?}", 4, &value));
+    CHECK(value == 42);
+
+    // Nested commands, by path
+    CHECK(scallop->invoke_path(scallop, "list create", 3, create) == 0);
+    CHECK(scallop->invoke_path(scallop, " list  push ", 3, push) == 0);
+    list = scallop->list_by_name(scallop, "fruit");
+    CHECK(list != NULL);
+    CHECK(list->length(list) == 2);
+    CHECK(strcmp(list->get(list, 1), "kiwi") == 0);
+    CHECK(scallop->invoke_path(scallop, "list length", 2, length) == 2);
+
+    CHECK(scallop->invoke(scallop, 1, unknown) == ERROR_MARKER_DEC);
+    CHECK(scallop->invoke_path(scallop, "list nope", 2, length) ==
+          ERROR_MARKER_DEC);
+    CHECK(scallop->invoke_path(scallop, "", 2, length) == ERROR_MARKER_DEC);
+    CHECK(scallop->invoke(scallop, 0, unknown) == ERROR_MARKER_DEC);
+    CHECK(scallop->invoke(scallop, 2, loop) == ERROR_MARKER_DEC);
+    CHECK(scallop->construct_object(scallop) == NULL);
+
+    // Skipping the line costs less than dispatching it
+    invoked = fixture_allocs();
+    scallop->invoke(scallop, 3, assign);
+    invoked = fixture_allocs() - invoked;
+    dispatched = fixture_allocs();
+    scallop->dispatch(scallop, "assign x (6 * 7)");
+    dispatched = fixture_allocs() - dispatched;
+    CHECK(invoked < dispatched);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test dispatch batch")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    const char * lines[] = {
+        "assign x 1",
+        "routine bump",
+        "  assign x ({x} + {%1})",
+        "  return {x}",
+        "end",
+        "bump 2",
+        "",
+        "bump 3",
+        "unreg bump",
+        "bump 4",
+        "routine bump",
+        "  return 99",
+        "end",
+        "bump 5",
+        "quit",
+        "print never"
+    };
+    const char * repeated[] = {
+        "assign y ({x} + 1)",
+        "assign y ({x} + 1)",
+        "assign y ({x} + 1)",
+        "assign y ({x} + 1)"
+    };
+    int results[16];
+    size_t batched = 0;
+    size_t dispatched = 0;
+    size_t index = 0;
+    long value = 0;
+
+    // A command looked up before being removed and registered again is
+    // looked up afresh
+    CHECK(scallop->dispatch_batch(scallop, lines, 16, results) == 15);
+    CHECK(results[5] == 3);
+    CHECK(results[6] == 3);
+    CHECK(results[7] == 6);
+    CHECK(results[9] == ERROR_MARKER_DEC);
+    CHECK(results[13] == 99);
+    CHECK(scallop->evaluate_value(scallop, "{x}", 3, &value));
+    CHECK(value == 6);
+
+    scallop->destroy(scallop);
+    scallop = scallop_pub.create(console, register_builtin_commands, "TEST");
+    scallop->dispatch(scallop, "assign x 1");
+
+    // Lines after the first reuse the batch's buffers
+    batched = fixture_allocs();
+    scallop->dispatch_batch(scallop, repeated, 4, NULL);
+    batched = fixture_allocs() - batched;
+    dispatched = fixture_allocs();
+    for (index = 0; index < 4; index++)
+    {
+        scallop->dispatch(scallop, repeated[index]);
+    }
+    dispatched = fixture_allocs() - dispatched;
+    CHECK(batched < dispatched);
+    CHECK(scallop->evaluate_value(scallop, "{y}", 3, &value));
+    CHECK(value == 2);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test run batch")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    pthread_t writer;
+    FILE * input = NULL;
+    int fds[2] = { -1, -1 };
+    long value = 0;
+
+    CHECK(pipe(fds) == 0);
+    input = fdopen(fds[0], "r");
+    CHECK(input != NULL);
+    CHECK(pthread_create(&writer, NULL, split_writer, &fds[1]) == 0);
+    CHECK(scallop->run_batch(scallop, input) == 0);
+    pthread_join(writer, NULL);
+    fclose(input);
+
+    CHECK(scallop->evaluate_value(scallop, "{a}", 3, &value));
+    CHECK(value == 1);
+    CHECK(scallop->evaluate_value(scallop, "{b}", 3, &value));
+    CHECK(value == 22);
+    CHECK(scallop->evaluate_value(scallop, "{c}", 3, &value));
+    CHECK(value == 3);
+
+    // A read that fails, as on a directory, is not the end of input
+    input = fopen(".", "r");
+    CHECK(input != NULL);
+    CHECK(scallop->run_batch(scallop, input) == -1);
+    fclose(input);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test run file")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    const char * text = "assign d 4\r\nassign e 5\r";
+    char path[32];
+    FILE * file = NULL;
+    int fds[2] = { -1, -1 };
+    long value = 0;
+
+    // Mapped, with a last line that has a carriage return but no newline
+    file = fopen("test_run_file.sc", "w");
+    CHECK(file != NULL);
+    fputs(text, file);
+    fclose(file);
+    CHECK(scallop->run_file(scallop, "test_run_file.sc") == 0);
+    CHECK(scallop->evaluate_value(scallop, "({d} + {e})", 11, &value));
+    CHECK(value == 9);
+    remove("test_run_file.sc");
+
+    // A pipe can't be mapped, so it's read instead
+    scallop->dispatch(scallop, "assign e 0");
+    CHECK(pipe(fds) == 0);
+    CHECK(write(fds[1], text, strlen(text)) == (ssize_t) strlen(text));
+    close(fds[1]);
+    snprintf(path, sizeof(path), "/dev/fd/%d", fds[0]);
+    CHECK(scallop->run_file(scallop, path) == 0);
+    close(fds[0]);
+    CHECK(scallop->evaluate_value(scallop, "{e}", 3, &value));
+    CHECK(value == 5);
+
+    CHECK(scallop->run_file(scallop, "no/such/file.sc") == -1);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
+TEST_BEGIN("test buffered output")
+    FILE * output = fopen("test_output.tmp", "w");
+    CHECK(output != NULL);
+    console_t * console = console_pub.create(stdin, output, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    char text[64];
+    char expected[64];
+    char newline[8];
+
+    // Nothing is written until flushed
+    CHECK(scallop->buffer_output(scallop, true));
+    CHECK(console->get_outputf(console) != output);
+    scallop->dispatch(scallop, "print hello");
+    CHECK(!strcmp(read_text("test_output.tmp", text, sizeof(text)), ""));
+    scallop->dispatch(scallop, "flush");
+    read_text("test_output.tmp", text, sizeof(text));
+    CHECK(!strncmp(text, "hello", 5));
+
+    // Whatever ends a line is the console's business.  Expect it again.
+    snprintf(newline, sizeof(newline), "%.7s", &text[5]);
+    snprintf(expected, sizeof(expected), "hello%sagain%s", newline, newline);
+
+    // Or until buffering stops, when the console gets its stream back
+    scallop->dispatch(scallop, "print again");
+    CHECK(!strncmp(read_text("test_output.tmp", text, sizeof(text)), "hello", 5));
+    CHECK(!strstr(text, "again"));
+    CHECK(scallop->buffer_output(scallop, false));
+    CHECK(console->get_outputf(console) == output);
+    CHECK(!strcmp(read_text("test_output.tmp", text, sizeof(text)), expected));
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+    fclose(output);
+    remove("test_output.tmp");
+TEST_END
+
+TEST_BEGIN("test variable providers")
+    console_t * console = console_pub.create(stdin, stdout, "test-history.txt");
+    scallop_t * scallop = scallop_pub.create(console,
+                                             register_builtin_commands,
+                                             "TEST");
+    CHECK(scallop != NULL);
+
+    size_t cached = 0;
+    size_t uncached = 0;
+    size_t missing = 0;
+    long value = 0;
+
+    CHECK(scallop->provide_variable(scallop, "cached", counting_provider,
+                                    &cached, true));
+    CHECK(scallop->provide_variable(scallop, "uncached", counting_provider,
+                                    &uncached, false));
+    CHECK(scallop->provide_variable(scallop, "missing", counting_provider,
+                                    &missing, false));
+    CHECK(!scallop->provide_variable(scallop, "", counting_provider,
+                                     &missing, false));
+
+    // Nothing is computed until referenced
+    scallop->dispatch(scallop, "assign x 1");
+    CHECK(cached == 0 && uncached == 0 && missing == 0);
+
+    // Cached values last for the line, and no longer
+    scallop->dispatch(scallop, "assign x ({cached} + {cached})");
+    CHECK(cached == 1);
+    CHECK(scallop->evaluate_value(scallop, "{x}", 3, &value));
+    CHECK(value == 2);
+    scallop->dispatch(scallop, "assign x {cached}");
+    CHECK(cached == 2);
+
+    scallop->dispatch(scallop, "assign x ({uncached} + {uncached})");
+    CHECK(uncached == 2);
+    CHECK(scallop->evaluate_value(scallop, "{x}", 3, &value));
+    CHECK(value == 3);
+
+    // No value is the same as no variable
+    scallop->dispatch(scallop, "assign x {missing}");
+    CHECK(missing == 1);
+    CHECK(scallop->evaluate_value(scallop, "{%?}", 4, &value));
+    CHECK(value == ERROR_MARKER_DEC);
+
+    // Providers come ahead of assigned variables, until removed
+    scallop->dispatch(scallop, "assign cached 42");
+    CHECK(scallop->evaluate_value(scallop, "{cached}", 8, &value));
+    CHECK(value == 3);
+    CHECK(scallop->unprovide_variable(scallop, "cached"));
+    CHECK(!scallop->unprovide_variable(scallop, "cached"));
+    CHECK(scallop->evaluate_value(scallop, "{cached}", 8, &value));
+    CHECK(value == 42);
+
+    scallop->destroy(scallop);
+    console->destroy(console);
+TEST_END
+
 TEST_BEGIN("test register/unregister")
     CHECK(true);
 TEST_END
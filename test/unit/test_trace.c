@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "blammo.h"
+#include "utils.h"
+#include "mut.h"
+
+#include "trace.h"
+
+//------------------------------------------------------------------------|
+// Read back a dumped trace, counting each phase and noting the first
+static void count_phases(const char * path,
+                         size_t * begins,
+                         size_t * ends,
+                         char * first)
+{
+    char text[4096] = { 0 };
+    const char * phase = text;
+    FILE * file = fopen(path, "r");
+
+    *begins = 0;
+    *ends = 0;
+    *first = '\0';
+    if (!file)
+    {
+        return;
+    }
+
+    fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+
+    while ((phase = strstr(phase, "\"ph\":\"")) != NULL)
+    {
+        phase += strlen("\"ph\":\"");
+        *first = *first ? *first : *phase;
+        *begins += (*phase == 'B');
+        *ends += (*phase == 'E');
+    }
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_trace.log");
+    BLAMMO(INFO, "trace tests...");
+
+TEST_BEGIN("test create/destroy")
+    scallop_trace_t * trace = scallop_trace_pub.create(0);
+    CHECK(trace != NULL);
+    CHECK(trace->count(trace) == 0);
+    CHECK(trace->dropped(trace) == 0);
+    trace->destroy(trace);
+TEST_END
+
+TEST_BEGIN("test ring overwrites oldest")
+    scallop_trace_t * trace = scallop_trace_pub.create(4);
+    size_t index = 0;
+
+    for (index = 0; index < 6; index++)
+    {
+        trace->record(trace, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                      "test", "event", SIZE_MAX, 0);
+    }
+
+    CHECK(trace->count(trace) == 4);
+    CHECK(trace->dropped(trace) == 2);
+    trace->clear(trace);
+    CHECK(trace->count(trace) == 0);
+    trace->destroy(trace);
+TEST_END
+
+TEST_BEGIN("test dump balances events")
+    scallop_trace_t * trace = scallop_trace_pub.create(4);
+    size_t begins = 0;
+    size_t ends = 0;
+    char first = '\0';
+
+    // Only the last four survive: b's begin and end, a's end with its
+    // begin overwritten, and c's begin, still open.
+    trace->record(trace, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", "a", SIZE_MAX, 0);
+    trace->record(trace, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", "b", SIZE_MAX, 1);
+    trace->record(trace, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", NULL, 0, 1);
+    trace->record(trace, 'E', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", NULL, 0, 0);
+    trace->record(trace, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", "c", SIZE_MAX, 0);
+
+    CHECK(trace->dump(trace, "test_trace.json"));
+    count_phases("test_trace.json", &begins, &ends, &first);
+    CHECK(first == 'B');
+    CHECK(begins == 2);
+    CHECK(ends == 2);
+
+    // Tracks balance separately
+    trace->clear(trace);
+    trace->record(trace, 'B', SCALLOP_TRACE_TRACK_CONSTRUCT,
+                  "test", "while", SIZE_MAX, 0);
+    trace->record(trace, 'B', SCALLOP_TRACE_TRACK_DISPATCH,
+                  "test", "end", SIZE_MAX, 0);
+    trace->record(trace, 'E', SCALLOP_TRACE_TRACK_CONSTRUCT,
+                  "test", NULL, 0, 0);
+    CHECK(trace->dump(trace, "test_trace.json"));
+    count_phases("test_trace.json", &begins, &ends, &first);
+    CHECK(begins == 2);
+    CHECK(ends == 2);
+
+    CHECK(!trace->dump(trace, "/nonexistent/dir/trace.json"));
+    remove("test_trace.json");
+    trace->destroy(trace);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2024 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include "blammo.h"
+#include "utils.h"
+#include "mut.h"
+
+#include "writer.h"
+
+#define TEST_WRITER_FILE    "test_writer.txt"
+#define TEST_WRITER_COUNT   10000
+
+static void test_writer_format(FILE * file, const void * record)
+{
+    fprintf(file, "%d\n", *(const int *) record);
+}
+
+// Count the lines written, checking they are in order
+static size_t test_writer_lines()
+{
+    FILE * file = fopen(TEST_WRITER_FILE, "r");
+    size_t lines = 0;
+    int previous = -1;
+    int value = 0;
+
+    while (file && fscanf(file, "%d", &value) == 1 && value > previous)
+    {
+        previous = value;
+        lines++;
+    }
+
+    if (file)
+    {
+        fclose(file);
+    }
+
+    return lines;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_writer.log");
+    BLAMMO(INFO, "writer tests...");
+
+TEST_BEGIN("test create/destroy")
+    CHECK(scallop_writer_pub.create(TEST_WRITER_FILE, false, 0, 1,
+                                    test_writer_format,
+                                    SCALLOP_WRITER_DROP) == NULL);
+    CHECK(scallop_writer_pub.create("/no/such/dir/file", false, 4, 1,
+                                    test_writer_format,
+                                    SCALLOP_WRITER_DROP) == NULL);
+
+    scallop_writer_t * writer = scallop_writer_pub.create(
+            TEST_WRITER_FILE, false, sizeof(int), 16,
+            test_writer_format, SCALLOP_WRITER_DROP);
+    CHECK(writer != NULL);
+    CHECK(writer->flush(writer));
+    CHECK(writer->dropped(writer) == 0);
+    writer->destroy(writer);
+    CHECK(test_writer_lines() == 0);
+TEST_END
+
+TEST_BEGIN("test waiting for room")
+    scallop_writer_t * writer = scallop_writer_pub.create(
+            TEST_WRITER_FILE, false, sizeof(int), 4,
+            test_writer_format, SCALLOP_WRITER_WAIT);
+    int value = 0;
+    CHECK(writer != NULL);
+
+    for (value = 0; value < TEST_WRITER_COUNT; value++)
+    {
+        CHECK(writer->push(writer, &value));
+    }
+
+    CHECK(writer->flush(writer));
+    CHECK(test_writer_lines() == TEST_WRITER_COUNT);
+
+    // Destroying writes out what is left
+    CHECK(writer->push(writer, &value));
+    writer->destroy(writer);
+    CHECK(test_writer_lines() == TEST_WRITER_COUNT + 1);
+TEST_END
+
+TEST_BEGIN("test dropping when full")
+    scallop_writer_t * writer = scallop_writer_pub.create(
+            TEST_WRITER_FILE, false, sizeof(int), 4,
+            test_writer_format, SCALLOP_WRITER_DROP);
+    size_t pushed = 0;
+    int value = 0;
+    CHECK(writer != NULL);
+
+    for (value = 0; value < TEST_WRITER_COUNT; value++)
+    {
+        pushed += writer->push(writer, &value);
+    }
+
+    // Whatever wasn't dropped is written, in order
+    CHECK(writer->flush(writer));
+    CHECK(pushed + writer->dropped(writer) == TEST_WRITER_COUNT);
+    CHECK(test_writer_lines() == pushed);
+    writer->destroy(writer);
+
+    CHECK(remove(TEST_WRITER_FILE) == 0);
+TEST_END
+
+TESTSUITE_END